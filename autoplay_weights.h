@@ -0,0 +1,20 @@
+/* autoplay_weights.h
+* -----------------------------------
+* GENERATED by host/tune.c (make tune; ./tune) -- rerun the tuner, don't edit by hand.
+*
+* Autoplayer evaluation weights after 16 generations of cross-entropy tuning (elite mean score 18212
+* over 8 seeded games of up to 1000 pieces with the greedy autoplayer).
+*/
+
+#ifndef _AUTOPLAY_WEIGHTS_H
+#define _AUTOPLAY_WEIGHTS_H
+
+#define AUTOPLAY_TUNED_WEIGHTS { \
+    .score = 2, \
+    .holes = -43, \
+    .height = -14, \
+    .bumpiness = -10, \
+    .wells = 1, \
+}
+
+#endif
@@ -0,0 +1,257 @@
+/* autoplayer.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The autoplayer.c module plays the game by itself (see autoplayer.h). For every board in the beam it tries each
+* placement of the falling piece (with and without a swap) on a scratch copy of the game, through the engine's
+* own lock and spawn, and keeps the beamWidth best boards for the next piece. Games, boards and snapshots are the
+* engine's, so the boards it reaches are exactly the ones the game would reach.
+*/
+
+#include "autoplayer.h"
+#include "board.h"
+#include "autoplay_weights.h"
+#include "game_scheduler.h"
+#include "timer.h"
+
+// Weights the player uses unless given others: tuned on the host (see host/tune.c and autoplay_weights.h)
+const autoplay_weights_t autoplay_default_weights = AUTOPLAY_TUNED_WEIGHTS;
+
+#define LOST_VALUE (-0x3FFFFFFF)   // value of a board where the game is over
+
+// Required init: a player for nrows x ncols games searching depth pieces ahead, keeping beamWidth boards at each
+// depth
+void autoplayer_init(autoplayer_t* player, int nrows, int ncols, const autoplay_weights_t* weights, int beamWidth, int depth) {
+    player->weights = *weights;
+    player->beamWidth = (beamWidth < 1) ? 1 : (beamWidth > AUTOPLAY_MAX_BEAM) ? AUTOPLAY_MAX_BEAM : beamWidth;
+    player->depth = (depth < 1) ? 1 : (depth > AUTOPLAY_MAX_DEPTH) ? AUTOPLAY_MAX_DEPTH : depth;
+    player->useSwap = true;
+    placement_init(&player->search, nrows, ncols);
+    game_engine_init(&player->scratch, nrows, ncols, 0);
+    player->nodes = 0;
+    player->searches = 0;
+}
+
+void autoplayer_free(autoplayer_t* player) {
+    placement_free(&player->search);
+    game_engine_free(&player->scratch);
+}
+
+// Height of column x: rows from its topmost square to the bottom
+static int columnHeight(const board_t* board, int x) {
+    return BOARD_NROWS(board) - board_column_top(board, x);
+}
+
+// Helper to count holes: empty squares below the top of their column. With row masks that's one AND per row
+// (walls masked off); otherwise each column is scanned below its top.
+static int countHoles(const board_t* board) {
+    int holes = 0;
+    if (board_bitboard_supported(board)) {
+        unsigned long columns = ((1UL << BOARD_NCOLS(board)) - 1) << WALL_BITS;
+        unsigned long covered = 0;
+        for (int y = 0; y < BOARD_NROWS(board); y++) {
+            unsigned long row = board_row_mask(board, y) & columns;
+            for (unsigned long gaps = covered & ~row; gaps != 0; gaps &= gaps - 1) holes++;
+            covered |= row;
+        }
+        return holes;
+    }
+    for (int x = 0; x < BOARD_NCOLS(board); x++) {
+        for (int y = board_column_top(board, x) + 1; y < BOARD_NROWS(board); y++) {
+            if (board_get_square(board, x, y) == BOARD_EMPTY) holes++;
+        }
+    }
+    return holes;
+}
+
+// Returns the value of state for the player (higher is better): the weighted sum of the score and the features of
+// its board
+int autoplayer_evaluate(const autoplay_weights_t* weights, const game_state_t* state) {
+    if (state->gameOver) return LOST_VALUE;
+    const board_t* board = &state->board;
+    int ncols = GAME_NCOLS(state);
+    int aggregate = 0, bumpiness = 0, wells = 0;
+    int left = GAME_NROWS(state);       // the wall left of column 0 counts as a full column
+    int here = columnHeight(board, 0);
+    for (int x = 0; x < ncols; x++) {
+        int right = (x + 1 < ncols) ? columnHeight(board, x + 1) : GAME_NROWS(state);
+        aggregate += here;
+        if (x + 1 < ncols) bumpiness += (here > right) ? here - right : right - here;
+        int rim = (left < right) ? left : right;
+        if (rim > here) wells += rim - here;
+        left = here;
+        here = right;
+    }
+    return weights->score * state->score + weights->holes * countHoles(board) + weights->height * aggregate
+           + weights->bumpiness * bumpiness + weights->wells * wells;
+}
+
+// Makes move on state: swap (if the move has one), then lock the piece at the move's placement and bring in the
+// next piece. Returns the EVENT_* bits of game_engine_step.
+int autoplayer_apply(game_state_t* state, const autoplay_move_t* move) {
+    if (move->swap) game_engine_swap(state, &state->piece);
+    state->piece.x = move->placement.x;
+    state->piece.y = move->placement.y;
+    state->piece.rotation = move->placement.rotation;
+    return game_engine_step(state, INPUT_DOWN);     // resting, so it locks
+}
+
+// Helper to offer a candidate for the next beam: best keeps the beamWidth best candidates so far, best first
+static void offerCandidate(autoplayer_t* player, int* nbest, int parent, const autoplay_move_t* move, int value) {
+    int at = *nbest;
+    while (at > 0 && player->best[at - 1].value < value) at--;
+    if (at >= player->beamWidth) return;
+    int last = (*nbest < player->beamWidth) ? (*nbest)++ : *nbest - 1;
+    for (int n = last; n > at; n--) player->best[n] = player->best[n - 1];
+    player->best[at].parent = parent;
+    player->best[at].move = *move;
+    player->best[at].value = value;
+}
+
+// Helper to put the scratch game in the state of beam node, swapped if swap; false if the swap doesn't fit
+static bool restoreScratch(autoplayer_t* player, const autoplay_node_t* node, bool swap) {
+    game_engine_restore(&player->scratch, &node->snapshot);
+    return !swap || game_engine_swap(&player->scratch, &player->scratch.piece);
+}
+
+/* Searches for the best move for state's falling piece: the first move on the way to the best board found depth
+pieces ahead. Returns false if there's no move (game over, or the piece doesn't fit where it is).
+*/
+bool autoplayer_choose(autoplayer_t* player, const game_state_t* state, autoplay_move_t* move) {
+    if (state->gameOver) return false;
+    player->searches++;
+
+    autoplay_node_t* beam = player->beams[0];
+    autoplay_node_t* next = player->beams[1];
+    game_engine_save(state, &beam[0].snapshot);
+    beam[0].value = 0;
+    int nbeam = 1;
+    bool found = false;
+
+    for (int level = 0; level < player->depth; level++) {
+        int nbest = 0;
+        for (int parent = 0; parent < nbeam; parent++) {
+            if (beam[parent].snapshot.gameOver) continue;
+            for (int swap = 0; swap <= (player->useSwap ? 1 : 0); swap++) {
+                if (!restoreScratch(player, &beam[parent], swap)) continue;
+                int count = placement_enumerate(&player->search, &player->scratch, &player->scratch.piece,
+                                                player->placements, AUTOPLAY_MAX_PLACEMENTS);
+                for (int n = 0; n < count; n++) {
+                    autoplay_move_t place = {.swap = false, .placement = player->placements[n]};   // swapped already
+                    if (n > 0) restoreScratch(player, &beam[parent], swap);
+                    autoplayer_apply(&player->scratch, &place);
+                    place.swap = swap;
+                    offerCandidate(player, &nbest, parent, &place, autoplayer_evaluate(&player->weights, &player->scratch));
+                    player->nodes++;
+                }
+            }
+        }
+        if (nbest == 0) break;      // every board in the beam is lost: keep the best one found before
+
+        // the next beam: the best candidates, played out again from their parents
+        for (int n = 0; n < nbest; n++) {
+            const autoplay_candidate_t* candidate = &player->best[n];
+            game_engine_restore(&player->scratch, &beam[candidate->parent].snapshot);
+            autoplayer_apply(&player->scratch, &candidate->move);
+            game_engine_save(&player->scratch, &next[n].snapshot);
+            next[n].value = candidate->value;
+            next[n].first = (level == 0) ? candidate->move : beam[candidate->parent].first;
+        }
+        for (int n = 0; n < nbeam; n++) game_engine_release_snapshot(&beam[n].snapshot);
+        autoplay_node_t* done = beam;
+        beam = next;
+        next = done;
+        nbeam = nbest;
+        found = true;
+    }
+
+    if (found) *move = beam[0].first;
+    for (int n = 0; n < nbeam; n++) game_engine_release_snapshot(&beam[n].snapshot);
+    return found;
+}
+
+// Chooses and makes a move for state's falling piece; returns the EVENT_* bits of the move (EVENT_GAME_OVER if
+// there's no move to make)
+int autoplayer_play(autoplayer_t* player, game_state_t* state) {
+    autoplay_move_t move;
+    if (!autoplayer_choose(player, state, &move)) {
+        state->gameOver = true;
+        return EVENT_GAME_OVER;
+    }
+    return autoplayer_apply(state, &move);
+}
+
+// Starts an anytime search for state's falling piece (stopping any search task was running)
+void autoplayer_task_start(autoplayer_t* player, autoplay_task_t* task, const game_state_t* state) {
+    autoplayer_task_stop(task);
+    game_engine_save(state, &task->root.snapshot);
+    task->active = !state->gameOver;
+    task->pass = 0;
+    task->count = -1;
+    task->next = 0;
+    task->found = false;
+    task->nodes = task->slices = task->cycles = task->maxSliceCycles = 0;
+    if (!task->active) game_engine_release_snapshot(&task->root.snapshot);
+}
+
+// Helper to do one unit of the search: find the placements of the current pass, or try the next placement.
+// Returns false once there's nothing left to do.
+static bool taskStep(autoplayer_t* player, autoplay_task_t* task) {
+    if (task->pass > (player->useSwap ? 1 : 0)) return false;
+    if (task->count < 0) {
+        task->count = restoreScratch(player, &task->root, task->pass) ?
+            placement_enumerate(&player->search, &player->scratch, &player->scratch.piece, player->placements, AUTOPLAY_MAX_PLACEMENTS) : 0;
+        task->next = 0;
+    } else if (task->next < task->count) {
+        autoplay_move_t place = {.swap = false, .placement = player->placements[task->next++]};
+        restoreScratch(player, &task->root, task->pass);
+        autoplayer_apply(&player->scratch, &place);
+        int value = autoplayer_evaluate(&player->weights, &player->scratch);
+        player->nodes++;
+        task->nodes++;
+        if (!task->found || value > task->bestValue) {
+            place.swap = task->pass;
+            task->best = place;
+            task->bestValue = value;
+            task->found = true;
+        }
+    }
+    if (task->count >= 0 && task->next >= task->count) {
+        task->pass++;
+        task->count = -1;
+    }
+    return true;
+}
+
+// Works on the search for up to budgetUs (at least one unit of work); returns true once the search is done.
+// Placements of a pass are tried from player->placements, so a player runs one task at a time.
+bool autoplayer_task_run(autoplayer_t* player, autoplay_task_t* task, unsigned long budgetUs) {
+    if (!task->active) return true;
+    unsigned long startCycles = game_scheduler_cycles();
+    unsigned long endTicks = timer_get_ticks() + budgetUs * TICKS_PER_USEC;
+    do {
+        if (!taskStep(player, task)) {
+            autoplayer_task_stop(task);
+            break;
+        }
+    } while ((long)(endTicks - timer_get_ticks()) > 0);
+
+    unsigned long cycles = game_scheduler_cycles() - startCycles;
+    task->slices++;
+    task->cycles += cycles;
+    if (cycles > task->maxSliceCycles) task->maxSliceCycles = cycles;
+    return !task->active;
+}
+
+// Best move found so far; false if none yet
+bool autoplayer_task_best(const autoplay_task_t* task, autoplay_move_t* move) {
+    if (task->found) *move = task->best;
+    return task->found;
+}
+
+// Ends the search (its best move so far stays available); does nothing if the search isn't running
+void autoplayer_task_stop(autoplay_task_t* task) {
+    if (!task->active) return;
+    game_engine_release_snapshot(&task->root.snapshot);
+    task->active = false;
+}
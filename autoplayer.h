@@ -0,0 +1,105 @@
+#ifndef _AUTOPLAYER_H
+#define _AUTOPLAYER_H
+
+#include <stdbool.h>
+#include "game_engine.h"
+#include "placement.h"
+
+/* A computer player for the game's own rules (the game's bag, swap with the next piece, tucks, 40/100/300/1200
+scoring): a beam search over the placements each piece can reach (see placement.h), scoring the boards it leads to
+with a weighted sum of board features. It works on a game_state_t like the engine, so it runs headless on the host
+(autoplay, benchmarks, tuning) as well as on the device. Weights are integers: the device has no floating point.
+*/
+typedef struct {
+    int score;          // per point scored
+    int holes;          // per empty square with a square above it in its column
+    int height;         // per square of aggregate column height
+    int bumpiness;      // per square of height difference between neighboring columns
+    int wells;          // per square of well depth (columns lower than both neighbors, walls count as high)
+} autoplay_weights_t;
+
+extern const autoplay_weights_t autoplay_default_weights;
+
+// A move: optionally swap the falling piece with the next piece, then lock it at placement
+typedef struct {
+    bool swap;
+    placement_t placement;
+} autoplay_move_t;
+
+#define AUTOPLAY_MAX_BEAM 32
+#define AUTOPLAY_MAX_DEPTH (PIECE_QUEUE_SIZE + 1)   // the falling piece plus the queue: pieces the player can see
+#define AUTOPLAY_MAX_PLACEMENTS 128                 // placements tried per piece
+
+// A board kept in the beam: the game after some moves, and the first of those moves
+typedef struct {
+    game_snapshot_t snapshot;
+    int value;
+    autoplay_move_t first;
+} autoplay_node_t;
+
+// A board that may go into the next beam, kept as the move that leads to it from a node of the current beam
+typedef struct {
+    int parent;
+    autoplay_move_t move;
+    int value;
+} autoplay_candidate_t;
+
+/* Search settings and workspace of one player (nothing is global, so give every thread its own player). Each
+beam node holds a snapshot, so a search holds up to 2 * beamWidth + 1 boards at once: in a STATIC_BOARD build
+that has to fit in BOARD_POOL_SIZE.
+*/
+typedef struct {
+    autoplay_weights_t weights;
+    int beamWidth;              // boards kept at each depth (up to AUTOPLAY_MAX_BEAM)
+    int depth;                  // pieces searched ahead, the falling piece included (1 -> greedy)
+    bool useSwap;               // also try swapping the falling piece with the next piece
+    placement_search_t search;
+    game_state_t scratch;       // game the moves are tried on
+    placement_t placements[AUTOPLAY_MAX_PLACEMENTS];
+    autoplay_node_t beams[2][AUTOPLAY_MAX_BEAM];
+    autoplay_candidate_t best[AUTOPLAY_MAX_BEAM];
+    unsigned long nodes;        // boards evaluated
+    unsigned long searches;     // calls to autoplayer_choose
+} autoplayer_t;
+
+/* Anytime search for the game loop's idle time: the best greedy move for one piece (with and without a swap, like
+autoplayer_choose with depth 1), worked through in slices of bounded time. A slice stops as soon as its time is up
+(after at least one unit of work: finding the placements of one pass, or trying one placement), and the best move
+found so far is there to use at any point. Slice costs are counted in CPU cycles (see game_scheduler_cycles).
+*/
+typedef struct {
+    bool active;                // started and not yet done
+    autoplay_node_t root;       // game at the start of the search
+    int pass;                   // 0: the falling piece, 1: swapped with the next piece
+    int count;                  // placements of this pass (-1 until found)
+    int next;                   // next placement to try
+    bool found;
+    autoplay_move_t best;
+    int bestValue;
+    unsigned long nodes;        // boards evaluated for this piece
+    unsigned long slices;       // slices this piece's search has taken
+    unsigned long cycles;       // cycles spent in them
+    unsigned long maxSliceCycles;
+} autoplay_task_t;
+
+void autoplayer_init(autoplayer_t* player, int nrows, int ncols, const autoplay_weights_t* weights, int beamWidth, int depth);
+
+void autoplayer_free(autoplayer_t* player);
+
+int autoplayer_evaluate(const autoplay_weights_t* weights, const game_state_t* state);
+
+bool autoplayer_choose(autoplayer_t* player, const game_state_t* state, autoplay_move_t* move);
+
+int autoplayer_apply(game_state_t* state, const autoplay_move_t* move);
+
+int autoplayer_play(autoplayer_t* player, game_state_t* state);
+
+void autoplayer_task_start(autoplayer_t* player, autoplay_task_t* task, const game_state_t* state);
+
+bool autoplayer_task_run(autoplayer_t* player, autoplay_task_t* task, unsigned long budgetUs);
+
+bool autoplayer_task_best(const autoplay_task_t* task, autoplay_move_t* move);
+
+void autoplayer_task_stop(autoplay_task_t* task);
+
+#endif
@@ -0,0 +1,204 @@
+/* board.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+* 
+* The board.c module stores the squares of fallen pieces for game_update.c: a 4-bit palette index per square plus a
+* bitboard occupancy mask per row, with rows kept in a ring so clearing a line never shifts the rows above it.
+* It also keeps the surface height of every column up to date, so landing rows can be found without scanning.
+* Boards are copy-on-write: board_share gives a second board_t on the same storage in O(1) (e.g. for a snapshot),
+* and storage is only copied when a shared board is about to change.
+*/
+
+#include "board.h"
+#include "assert.h"
+#include "strings.h"
+#ifndef STATIC_BOARD
+#include "malloc.h"
+#endif
+
+// Header of the single allocation holding all of a board's arrays (masks, cells, ring, heights follow it)
+struct board_storage {
+    unsigned long refs;     // number of board_t's using this storage
+    unsigned long size;     // bytes in the allocation, header included
+};
+
+// Bytes of storage for an nrows x ncols board
+#define STORAGE_SIZE(nrows, ncols) (sizeof(struct board_storage) + (nrows) * sizeof(unsigned long) \
+                                    + (((nrows) * (((ncols) + 1) / 2) + 3) & ~3) + 2 * (nrows) * sizeof(int) + (ncols) * sizeof(int))
+
+#ifdef STATIC_BOARD
+// Zero-heap build: every board's storage is a slot of this pool, free while its refs count is 0
+static unsigned long storage_pool[BOARD_POOL_SIZE][(STORAGE_SIZE(NROWS, NCOLS) + sizeof(unsigned long) - 1) / sizeof(unsigned long)];
+
+static struct board_storage* allocStorage(unsigned long size) {
+    for (int slot = 0; slot < BOARD_POOL_SIZE; slot++) {
+        struct board_storage* storage = (struct board_storage*)storage_pool[slot];
+        if (storage->refs == 0) return storage;
+    }
+    assert(false);  // pool exhausted: raise BOARD_POOL_SIZE
+    return NULL;
+}
+
+static void freeStorage(struct board_storage* storage) {
+    storage->refs = 0;
+}
+#else
+static struct board_storage* allocStorage(unsigned long size) {
+    return malloc(size);
+}
+
+static void freeStorage(struct board_storage* storage) {
+    free(storage);
+}
+#endif
+
+// Row mask of an empty board row (only the wall bits set)
+static unsigned long emptyRowMask(const board_t* board) {
+    if (!board_bitboard_supported(board)) return FULL_ROW;
+    return ~(((1UL << BOARD_NCOLS(board)) - 1) << WALL_BITS);
+}
+
+// Helper to point logical row y at physical row phys (writes both halves of the mirrored ring)
+static void setRing(board_t* board, int y, int phys) {
+    int slot = board->base + y;
+    if (slot >= BOARD_NROWS(board)) slot -= BOARD_NROWS(board);
+    board->ring[slot] = phys;
+    board->ring[slot + BOARD_NROWS(board)] = phys;
+}
+
+// Helper to find the new top of column x after its top square went away: the first filled square at or
+// below fromRow (squares above fromRow are known to be empty)
+static void rescanColumn(board_t* board, int x, int fromRow) {
+    int row = fromRow;
+    while (row < BOARD_NROWS(board) && board_get_square(board, x, row) == BOARD_EMPTY) row++;
+    board->heights[x] = row;
+}
+
+// Helper to point the board's array pointers into storage (masks first, as they need the widest alignment)
+static void attachStorage(board_t* board, struct board_storage* storage) {
+    board->storage = storage;
+    board->masks = (unsigned long*)(storage + 1);
+    board->cells = (unsigned char*)(board->masks + BOARD_NROWS(board));
+    board->ring = (int*)(board->cells + ((BOARD_NROWS(board) * BOARD_ROW_BYTES(board) + 3) & ~3));
+    board->heights = board->ring + 2 * BOARD_NROWS(board);
+}
+
+// Helper to give the board storage of its own before it changes, if the storage is shared with another board
+static void makeWritable(board_t* board) {
+    struct board_storage* shared = board->storage;
+    if (shared->refs == 1) return;
+    struct board_storage* copy = allocStorage(shared->size);
+    memcpy(copy, shared, shared->size);
+    copy->refs = 1;
+    shared->refs--;
+    attachStorage(board, copy);
+}
+
+// Required init: allocates an empty nrows x ncols board (in a STATIC_BOARD build, nrows x ncols must be NROWS x NCOLS)
+void board_init(board_t* board, int nrows, int ncols) {
+#ifdef STATIC_BOARD
+    assert(nrows == NROWS && ncols == NCOLS);
+#endif
+    board->nrows = nrows;
+    board->ncols = ncols;
+    board->rowBytes = (ncols + 1) / 2;
+    unsigned long size = STORAGE_SIZE(nrows, ncols);
+    struct board_storage* storage = allocStorage(size);
+    storage->refs = 1;
+    storage->size = size;
+    attachStorage(board, storage);
+
+    memset(board->cells, 0, nrows * board->rowBytes);
+    board->base = 0;
+    for (int col = 0; col < ncols; col++) board->heights[col] = nrows;
+    for (int row = 0; row < nrows; row++) {
+        board->masks[row] = emptyRowMask(board);
+        setRing(board, row, row);
+    }
+}
+
+// Releases the board's storage (freed once no other board shares it)
+void board_free(board_t* board) {
+    if (board->storage != NULL && --board->storage->refs == 0) freeStorage(board->storage);
+    board->storage = NULL;
+    board->cells = NULL;
+    board->masks = NULL;
+    board->ring = NULL;
+    board->heights = NULL;
+}
+
+// Makes dest a copy of src in O(1): both share src's storage until one of them changes (copy-on-write)
+// dest must not hold storage of its own (free it first)
+void board_share(board_t* dest, const board_t* src) {
+    *dest = *src;
+    dest->storage->refs++;
+}
+
+// True if one row of the board (plus its walls) fits in a row mask; masks are all full otherwise
+bool board_bitboard_supported(const board_t* board) {
+    return BOARD_NCOLS(board) <= BITBOARD_MAX_COLS;
+}
+
+// Fills square (x, y) with palette index `square` (1 through 15; keeps the row's bitboard mask in sync)
+void board_set_square(board_t* board, int x, int y, int square) {
+    makeWritable(board);
+    int phys = board->ring[board->base + y];
+    unsigned char* pair = &board->cells[phys * BOARD_ROW_BYTES(board) + (x >> 1)];
+    if (x & 1) *pair = (*pair & 0x0F) | (square << 4);
+    else *pair = (*pair & 0xF0) | square;
+    if (board_bitboard_supported(board)) board->masks[phys] |= 1UL << (WALL_BITS + x);
+    if (y < board->heights[x]) board->heights[x] = y;
+}
+
+bool board_is_row_filled(const board_t* board, int y) {
+    if (board_bitboard_supported(board)) return board_row_mask(board, y) == FULL_ROW;
+    const unsigned char* row = board_row(board, y);
+    for (int pair = 0; pair < BOARD_NCOLS(board) / 2; pair++) {
+        // if we find an empty square (either nibble of a pair), the row is not filled
+        if ((row[pair] & 0x0F) == 0 || (row[pair] & 0xF0) == 0) return false;
+    }
+    if ((BOARD_NCOLS(board) & 1) && (row[BOARD_NCOLS(board) / 2] & 0x0F) == 0) return false;
+    return true;
+}
+
+// Empties logical row y in place (rows above stay where they are)
+void board_empty_row(board_t* board, int y) {
+    makeWritable(board);
+    int phys = board->ring[board->base + y];
+    memset(board->cells + phys * BOARD_ROW_BYTES(board), 0, BOARD_ROW_BYTES(board));
+    board->masks[phys] = emptyRowMask(board);
+    for (int col = 0; col < BOARD_NCOLS(board); col++) {
+        if (board->heights[col] == y) rescanColumn(board, col, y + 1);
+    }
+}
+
+// Removes logical row y: every row above it drops down by one and an empty row appears at the top.
+// The removed physical row is unlinked and recycled as the new top row. Only row indices on the shorter side
+// of y move: rows above shift down one slot, or rows below shift up one slot and the ring rotates by one.
+// O(ncols + min(y, nrows - 1 - y)), plus the rescan of any column whose top square was in row y.
+void board_remove_row(board_t* board, int y) {
+    makeWritable(board);
+    int phys = board->ring[board->base + y];
+    if (y <= BOARD_NROWS(board) - 1 - y) {
+        for (int row = y; row > 0; row--) setRing(board, row, board->ring[board->base + row - 1]);
+        setRing(board, 0, phys);
+    } else {
+        for (int row = y; row < BOARD_NROWS(board) - 1; row++) setRing(board, row, board->ring[board->base + row + 1]);
+        setRing(board, BOARD_NROWS(board) - 1, phys);
+        // rotating the ring back one step makes the old bottom slot (now holding the removed row) the top row
+        board->base = (board->base == 0) ? BOARD_NROWS(board) - 1 : board->base - 1;
+    }
+    memset(board->cells + phys * BOARD_ROW_BYTES(board), 0, BOARD_ROW_BYTES(board));
+    board->masks[phys] = emptyRowMask(board);
+
+    // columns topping out above y dropped by one; columns topping out in row y lost their top square
+    for (int col = 0; col < BOARD_NCOLS(board); col++) {
+        if (board->heights[col] < y) board->heights[col]++;
+        else if (board->heights[col] == y) rescanColumn(board, col, y + 1);
+    }
+}
+
+// Returns the logical row of the topmost square in column x (nrows if column is empty)
+int board_column_top(const board_t* board, int x) {
+    return board->heights[x];
+}
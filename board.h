@@ -0,0 +1,98 @@
+#ifndef _BOARD_H
+#define _BOARD_H
+
+#include <stdbool.h>
+
+/* Bitboard layout: in each row mask, board column `col` lives at bit (WALL_BITS + col). The bits to the left
+of column 0 and to the right of the last column are permanently set ("walls"), and rows above/below the board read
+as full rows, so a piece that pokes out of bounds collides with a wall instead of needing per-square bound checks.
+unsigned long is 64 bits on rv64 (lp64), which limits bitboard boards to BITBOARD_MAX_COLS columns.
+*/
+#define WALL_BITS 5         // pieces are at most 5 squares wide (PIECE_GRID), so they never reach past the walls
+#define BITBOARD_MAX_COLS (64 - 2 * WALL_BITS)
+#define FULL_ROW (~0UL)
+
+/* Board storage: rows live in a ring. Logical row y (0 = top) is stored in physical row ring[base + y]; the ring
+array holds 2 * nrows entries with the second half mirroring the first so lookups never wrap. Removing a row only
+moves row indices (on whichever side of the removed row has fewer rows) and recycles the removed physical row as
+the new top row -- squares are never copied, so removing row y costs O(ncols + min(y, nrows - 1 - y)): the emptied
+row and column heights, plus one index move per row on the shorter side. A column whose top square was in the
+removed row also rescans down to its next square, past any holes right under it.
+All arrays of a board live in one refcounted allocation, which board_t's can share (see board_share).
+Squares are palette indices, two to a byte (even column in the low nibble): BOARD_EMPTY or 1 through 15, with the
+palette owned by the board's user (game_engine.c uses its piece set's palette and resolves colors only when
+drawing).
+*/
+#define BOARD_EMPTY 0
+
+/* Build with -DSTATIC_BOARD (make STATIC_BOARD=1) to fix the board size at compile time: NROWS x NCOLS (20 x 10
+unless given). Board storage then comes from a static pool of BOARD_POOL_SIZE boards instead of the heap, and the
+BOARD_* size macros below are constants, so row strides and bounds are compile-time constants.
+*/
+#ifdef STATIC_BOARD
+#ifndef NROWS
+#define NROWS 20
+#endif
+#ifndef NCOLS
+#define NCOLS 10
+#endif
+#define BOARD_POOL_SIZE 24      // the game, its snapshot ring and a few boards for search/tests
+#define BOARD_NROWS(board) NROWS
+#define BOARD_NCOLS(board) NCOLS
+#define BOARD_ROW_BYTES(board) ((NCOLS + 1) / 2)
+#else
+#define BOARD_NROWS(board) ((board)->nrows)
+#define BOARD_NCOLS(board) ((board)->ncols)
+#define BOARD_ROW_BYTES(board) ((board)->rowBytes)
+#endif
+
+struct board_storage;
+
+typedef struct {
+    int nrows;
+    int ncols;
+    int rowBytes;               // bytes per row of cells, (ncols + 1) / 2
+    unsigned char* cells;       // nrows physical rows of ncols 4-bit squares
+    unsigned long* masks;       // bitboard occupancy mask of each physical row
+    int* ring;                  // logical -> physical row index (2 * nrows entries)
+    int base;
+    int* heights;               // surface of each column: logical row of its topmost square, nrows if empty
+    struct board_storage* storage;  // allocation holding the arrays above, possibly shared with other boards
+} board_t;
+
+void board_init(board_t* board, int nrows, int ncols);
+
+void board_free(board_t* board);
+
+void board_share(board_t* dest, const board_t* src);
+
+bool board_bitboard_supported(const board_t* board);
+
+void board_set_square(board_t* board, int x, int y, int square);
+
+bool board_is_row_filled(const board_t* board, int y);
+
+void board_empty_row(board_t* board, int y);
+
+void board_remove_row(board_t* board, int y);
+
+int board_column_top(const board_t* board, int x);
+
+// Returns the packed squares of logical row y (must be in bounds)
+static inline unsigned char* board_row(const board_t* board, int y) {
+    return board->cells + board->ring[board->base + y] * BOARD_ROW_BYTES(board);
+}
+
+// Returns the palette index of square (x, y) (must be in bounds), BOARD_EMPTY if empty
+static inline int board_get_square(const board_t* board, int x, int y) {
+    unsigned char pair = board_row(board, y)[x >> 1];
+    return (x & 1) ? (pair >> 4) : (pair & 0x0F);
+}
+
+// Returns the bitboard mask of logical row y; rows above or below the board are full
+static inline unsigned long board_row_mask(const board_t* board, int y) {
+    if ((unsigned int)y >= (unsigned int)BOARD_NROWS(board)) return FULL_ROW;
+    return board->masks[board->ring[board->base + y]];
+}
+
+#endif
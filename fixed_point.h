@@ -0,0 +1,42 @@
+#ifndef _FIXED_POINT_H
+#define _FIXED_POINT_H
+
+/* Fixed-point math for the device: the target is rv64im (no FPU), so any float or double arithmetic turns into
+calls to libgcc's soft-float helpers (the Makefile's link step fails if one gets linked in). Fractions are Q16.16
+(fix16_t, 16 integer and 16 fraction bits); constants can be written as FIX16_CONST(0.8), which the compiler folds
+to an integer at compile time.
+*/
+typedef int fix16_t;
+
+#define FIX16_SHIFT 16
+#define FIX16_ONE (1 << FIX16_SHIFT)
+#define FIX16_CONST(x) ((fix16_t)((x) * FIX16_ONE + ((x) >= 0 ? 0.5 : -0.5)))
+
+static inline fix16_t fix16_from_int(int n) {
+    return n * FIX16_ONE;
+}
+
+// Rounds toward negative infinity
+static inline int fix16_to_int(fix16_t a) {
+    return a >> FIX16_SHIFT;
+}
+
+static inline fix16_t fix16_mul(fix16_t a, fix16_t b) {
+    return (fix16_t)(((long)a * b) >> FIX16_SHIFT);
+}
+
+static inline fix16_t fix16_div(fix16_t a, fix16_t b) {
+    return (fix16_t)(((long)a << FIX16_SHIFT) / b);
+}
+
+// Returns fraction f of an unsigned quantity such as a tick count or duration (e.g. 80% of a loop period)
+static inline unsigned long fix16_scale(unsigned long n, fix16_t f) {
+    return (n * (unsigned long)f) >> FIX16_SHIFT;
+}
+
+// Time conversions (TICKS_PER_USEC from timer.h); integer only, so they're safe in hot loops
+#define USEC_TO_TICKS(usec) ((unsigned long)(usec) * TICKS_PER_USEC)
+#define MSEC_TO_TICKS(msec) ((unsigned long)(msec) * 1000 * TICKS_PER_USEC)
+#define TICKS_TO_USEC(ticks) ((ticks) / TICKS_PER_USEC)
+
+#endif
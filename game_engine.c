@@ -0,0 +1,401 @@
+/* game_engine.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The game_engine.c module holds the rules of our game of Tetris: moving, rotating, swapping, locking pieces,
+* clearing rows and scoring. All of it works on a game_state_t passed in by the caller and none of it draws or
+* waits, so game_update.c renders one game on screen while tests and host tools can run many games at once.
+* The pieces themselves (and their geometry tables) come from the piece sets in the generated piece_sets.c.
+*/
+
+#include "game_engine.h"
+#include "assert.h"
+#include "strings.h"
+
+// Returns precomputed geometry of piece in its current rotation
+const piece_geometry_t* game_engine_geometry(const falling_piece_t* piece) {
+    return &piece->pieceT.geometry[(int) piece->rotation];
+}
+
+// Required init: empty board, fresh bag seeded with `seed` (same seed -> same pieces) and a full piece queue,
+// playing with the pieces of `set`. Call game_engine_spawn to bring in the first falling piece
+void game_engine_init_with_set(game_state_t* state, const piece_set_t* set, int nrows, int ncols, unsigned int seed) {
+    assert(ncols <= PACKED_PIECE_MAX_COLS && nrows <= PACKED_PIECE_MAX_ROWS);  // piece positions must fit packed_piece_t
+    state->set = set;
+    state->nrows = nrows;
+    state->ncols = ncols;
+    state->score = 0;
+    state->linesCleared = 0;
+    state->gameOver = false;
+
+    board_init(&state->board, nrows, ncols);
+    state->bitboardMode = board_bitboard_supported(&state->board);
+    state->lockTopRow = nrows;
+    state->lockBottomRow = -1;
+    state->cleared.count = 0;
+
+    random_bag_init_seeded(&state->bag, seed, set->npieces);
+    state->queue.head = 0;
+    for (int n = 0; n < PIECE_QUEUE_SIZE; n++) state->queue.ids[n] = random_bag_choose_from(&state->bag);
+    memset(&state->piece, 0, sizeof(state->piece));
+}
+
+// Required init for a game of Tetris (tetromino_set)
+void game_engine_init(game_state_t* state, int nrows, int ncols, unsigned int seed) {
+    game_engine_init_with_set(state, &tetromino_set, nrows, ncols, seed);
+}
+
+void game_engine_free(game_state_t* state) {
+    board_free(&state->board);
+}
+
+// Bitboard collision test: returns true if the piece fits (in bounds, no overlap) with its top left corner at (x, y)
+// A whole-piece test is one AND per occupied row of the piece's grid (see board.h for the row mask layout)
+static bool bitboardFits(const game_state_t* state, falling_piece_t* piece, int x, int y) {
+    if (x < -WALL_BITS || x > GAME_NCOLS(state)) return false;
+    const piece_geometry_t* geom = game_engine_geometry(piece);
+    const board_t* board = &state->board;
+    int shift = x + WALL_BITS;
+
+    unsigned long overlap = 0;
+    for (int row = geom->minRow; row <= geom->maxRow; row++) {
+        overlap |= board_row_mask(board, y + row) & ((unsigned long)geom->rowBits[row] << shift);
+    }
+    return overlap == 0;
+}
+
+// Grid (non-bitboard) validity check: rejects out of bounds positions using the piece's bounding box, then
+// checks the background under each of the piece's precomputed squares
+static bool gridFits(const game_state_t* state, falling_piece_t* piece) {
+    const piece_geometry_t* geom = game_engine_geometry(piece);
+    if (piece->x + geom->minCol < 0 || piece->x + geom->maxCol >= GAME_NCOLS(state)) return false;
+    if (piece->y + geom->minRow < 0 || piece->y + geom->maxRow >= GAME_NROWS(state)) return false;
+
+    for (int cell = 0; cell < geom->ncells; cell++) {
+        if (board_get_square(&state->board, piece->x + geom->cells[cell][0], piece->y + geom->cells[cell][1]) != BOARD_EMPTY) return false;
+    }
+    return true;
+}
+
+// Grid (non-bitboard) fallen check: only the square at the bottom of each column of the piece can rest on
+// something, so just the bottom profile is checked
+static bool gridHasFallen(const game_state_t* state, falling_piece_t* piece) {
+    const piece_geometry_t* geom = game_engine_geometry(piece);
+    for (int col = geom->minCol; col <= geom->maxCol; col++) {
+        int below = piece->y + geom->bottom[col] + 1;
+        if (below >= GAME_NROWS(state) || board_get_square(&state->board, piece->x + col, below) != BOARD_EMPTY) return true;
+    }
+    return false;
+}
+
+// Selects collision engine: true for bitboard row masks, false for per-square grid checks
+// Bitboard mode can't be enabled for boards wider than BITBOARD_MAX_COLS columns
+void game_engine_set_bitboard_mode(game_state_t* state, bool enabled) {
+    state->bitboardMode = enabled && board_bitboard_supported(&state->board);
+}
+
+// Whole-piece check of whether the piece's current position is valid
+// Uses the bitboard (one AND per piece row) in bitboard mode, else checks the grid under the piece's squares
+bool game_engine_is_valid_position(const game_state_t* state, falling_piece_t* piece) {
+    if (state->bitboardMode) return bitboardFits(state, piece, piece->x, piece->y);
+    return gridFits(state, piece);
+}
+
+// Whole-piece check of whether the piece is resting on the stack (or ground); sets piece->fallen if so
+// Bitboard mode tests whether the piece would still fit one row lower, else checks the grid under its bottom profile
+bool game_engine_has_fallen(const game_state_t* state, falling_piece_t* piece) {
+    bool fallen = state->bitboardMode ? !bitboardFits(state, piece, piece->x, piece->y + 1) : gridHasFallen(state, piece);
+    if (fallen) piece->fallen = true;
+    return fallen;
+}
+
+// Returns the row the piece would land on if dropped straight down from its current position
+// When every column of the piece is above that column's surface, the landing row comes straight from the
+// column heights and the piece's bottom profile (constant time). A piece tucked under an overhang falls back
+// to stepping down one row at a time.
+int game_engine_landing_row(const game_state_t* state, falling_piece_t* piece) {
+    const piece_geometry_t* geom = game_engine_geometry(piece);
+    int landing = GAME_NROWS(state);
+    for (int col = geom->minCol; col <= geom->maxCol; col++) {
+        int top = board_column_top(&state->board, piece->x + col);
+        if (piece->y + geom->bottom[col] >= top) {
+            landing = -1;   // under the surface in this column, the profile doesn't apply
+            break;
+        }
+        int rest = top - 1 - geom->bottom[col];
+        if (rest < landing) landing = rest;
+    }
+    if (landing >= 0) return landing;
+
+    falling_piece_t probe = *piece;
+    do {
+        probe.y++;
+    } while (game_engine_is_valid_position(state, &probe));
+    return probe.y - 1;
+}
+
+// Returns the piece n pieces ahead (0 is the next piece), for n below PIECE_QUEUE_SIZE
+const piece_t* game_engine_peek(const game_state_t* state, int n) {
+    return &state->set->pieces[state->queue.ids[(state->queue.head + n) & (PIECE_QUEUE_SIZE - 1)]];
+}
+
+// Helper to take the next piece off the queue; its slot is refilled from the bag at the far end
+static const piece_t* popQueue(game_state_t* state) {
+    piece_queue_t* queue = &state->queue;
+    const piece_t* next = &state->set->pieces[queue->ids[queue->head]];
+    queue->ids[queue->head] = random_bag_choose_from(&state->bag);
+    queue->head = (queue->head + 1) & (PIECE_QUEUE_SIZE - 1);
+    return next;
+}
+
+// Brings in the next piece as state->piece (finishing any pending clear first, since a new piece can't spawn over
+// rows that haven't dropped yet). Returns false and ends the game if the new piece doesn't fit.
+bool game_engine_spawn(game_state_t* state) {
+    if (state->cleared.count > 0) game_engine_finish_clear(state);
+
+    falling_piece_t* piece = &state->piece;
+    piece->pieceT = *popQueue(state);
+    piece->rotation = 0;
+
+    // Subtract 2 from the board's center x-coordinate: half of a tetromino's 4 x 4 grid, and the center column
+    // of the 5 x 5 grid the pieces of other sets are drawn about
+    piece->x = (GAME_NCOLS(state) / 2) - 2;
+    piece->y = 0;
+    piece->fallen = false;
+
+    if (!game_engine_is_valid_position(state, piece)) {
+        state->gameOver = true;
+        return false;
+    }
+    game_engine_has_fallen(state, piece);
+    return true;
+}
+
+// These next functions move, rotate or swap a piece; each does nothing and returns false for an invalid move.
+// After a successful move the piece's fallen state is updated.
+bool game_engine_move(game_state_t* state, falling_piece_t* piece, int dx, int dy) {
+    piece->x += dx;
+    piece->y += dy;
+    if (!game_engine_is_valid_position(state, piece)) {
+        piece->x -= dx;
+        piece->y -= dy;
+        return false;
+    }
+    game_engine_has_fallen(state, piece);
+    return true;
+}
+
+// Moves piece down up to `rows` rows, stopping where it lands
+bool game_engine_move_down_by(game_state_t* state, falling_piece_t* piece, int rows) {
+    int landing = game_engine_landing_row(state, piece);
+    int target = (piece->y + rows < landing) ? piece->y + rows : landing;
+    if (target <= piece->y) return false;
+    piece->y = target;
+    game_engine_has_fallen(state, piece);
+    return true;
+}
+
+bool game_engine_rotate(game_state_t* state, falling_piece_t* piece) {
+    char origRotation = piece->rotation;
+    piece->rotation = (origRotation + 1) % 4;
+    if (!game_engine_is_valid_position(state, piece)) {
+        piece->rotation = origRotation;
+        return false;
+    }
+    game_engine_has_fallen(state, piece);
+    return true;
+}
+
+// Swaps piece with the next queued piece, if the next piece fits where the piece is
+bool game_engine_swap(game_state_t* state, falling_piece_t* piece) {
+    falling_piece_t swapPiece = *piece;
+    swapPiece.pieceT = *game_engine_peek(state, 0);
+    swapPiece.fallen = false;
+    if (!game_engine_is_valid_position(state, &swapPiece)) return false;
+
+    state->queue.ids[state->queue.head] = piece->pieceT.id;
+    piece->pieceT = swapPiece.pieceT;
+    game_engine_has_fallen(state, piece);
+    return true;
+}
+
+// Board squares hold the piece's palette index (0 is empty, see game_engine_square_color)
+int game_engine_square_of(const piece_t* piece) {
+    return piece->square;
+}
+
+// Embeds one square into the board (palette index and bitboard mask), remembering which rows were touched for the
+// next clear
+void game_engine_set_square(game_state_t* state, int x, int y, int square) {
+    board_set_square(&state->board, x, y, square);
+    if (y < state->lockTopRow) state->lockTopRow = y;
+    if (y > state->lockBottomRow) state->lockBottomRow = y;
+}
+
+// Empties filled rows and updates score; returns the number of rows cleared
+// Only the rows touched by squares locked since the last call can have been filled, so only those are checked.
+// The emptied rows stay in place (listed in state->cleared) until game_engine_finish_clear drops the rows above them.
+int game_engine_clear_rows(game_state_t* state) {
+    if (state->cleared.count > 0) game_engine_finish_clear(state);
+
+    int rowsFilled = 0;
+    for (int row = state->lockTopRow; row <= state->lockBottomRow; row++) {
+        if (board_is_row_filled(&state->board, row)) {
+            state->cleared.rows[rowsFilled] = row;
+            rowsFilled++;
+        }
+    }
+    state->lockTopRow = GAME_NROWS(state);
+    state->lockBottomRow = -1;
+
+    if (rowsFilled == 1) state->score += 40;
+    else if (rowsFilled == 2) state->score += 100;
+    else if (rowsFilled == 3) state->score += 300;
+    else if (rowsFilled >= 4) state->score += 1200;     // (a pentomino can clear 5)
+    state->linesCleared += rowsFilled;
+
+    for (int i = 0; i < rowsFilled; i++) {
+        board_empty_row(&state->board, state->cleared.rows[i]);
+    }
+    state->cleared.count = rowsFilled;
+    return rowsFilled;
+}
+
+// Locks piece into the board and clears any rows it filled; returns the number of rows cleared
+int game_engine_lock(game_state_t* state, falling_piece_t* piece) {
+    const piece_geometry_t* geom = game_engine_geometry(piece);
+    for (int cell = 0; cell < geom->ncells; cell++) {
+        game_engine_set_square(state, piece->x + geom->cells[cell][0], piece->y + geom->cells[cell][1], game_engine_square_of(&piece->pieceT));
+    }
+    return game_engine_clear_rows(state);
+}
+
+// Removes the rows emptied by the last clear: rows are recycled through the board's row ring (see board.h), so
+// nothing above them is copied. Removing top to bottom keeps the indices of the remaining cleared rows valid.
+void game_engine_finish_clear(game_state_t* state) {
+    for (int i = 0; i < state->cleared.count; i++) {
+        board_remove_row(&state->board, state->cleared.rows[i]);
+    }
+    state->cleared.count = 0;
+}
+
+// Helper to lock the falling piece and bring in the next one
+static int lockAndSpawn(game_state_t* state) {
+    int events = EVENT_LOCKED | EVENT_SPAWNED;
+    if (game_engine_lock(state, &state->piece) > 0) events |= EVENT_CLEARED;
+    if (!game_engine_spawn(state)) events |= EVENT_GAME_OVER;
+    return events;
+}
+
+// Applies one input to state->piece and returns the EVENT_* bits for what happened. Cleared rows are removed
+// as soon as the next piece spawns, so a headless game only ever needs to call this function.
+int game_engine_step(game_state_t* state, game_input_t input) {
+    if (state->gameOver) return EVENT_GAME_OVER;
+    falling_piece_t* piece = &state->piece;
+    int events = 0;
+
+    switch (input) {
+        case INPUT_LEFT:
+            if (game_engine_move(state, piece, -1, 0)) events |= EVENT_MOVED;
+            break;
+        case INPUT_RIGHT:
+            if (game_engine_move(state, piece, 1, 0)) events |= EVENT_MOVED;
+            break;
+        case INPUT_ROTATE:
+            if (game_engine_rotate(state, piece)) events |= EVENT_MOVED;
+            break;
+        case INPUT_SWAP:
+            if (game_engine_swap(state, piece)) events |= EVENT_MOVED;
+            break;
+        case INPUT_DOWN:
+            if (game_engine_move(state, piece, 0, 1)) events |= EVENT_MOVED;
+            else events |= lockAndSpawn(state);
+            break;
+        case INPUT_HARD_DROP:
+            if (game_engine_move_down_by(state, piece, GAME_NROWS(state))) events |= EVENT_MOVED;
+            events |= lockAndSpawn(state);
+            break;
+        case INPUT_NONE:
+            break;
+    }
+    return events;
+}
+
+// Default gravity: the original 480 ms tick for the first 10 lines, speeding up every 10 lines after that
+static const unsigned long defaultGravityUs[] = {
+    480000, 430000, 380000, 330000, 280000, 230000, 180000, 130000, 100000, 80000, 70000, 60000, 50000, 40000, 30000,
+};
+
+const gravity_curve_t game_engine_default_gravity = {
+    .linesPerLevel = 10,
+    .nlevels = sizeof(defaultGravityUs) / sizeof(defaultGravityUs[0]),
+    .periodUs = defaultGravityUs,
+};
+
+// Returns the time between gravity ticks after linesCleared lines
+unsigned long game_engine_gravity_us(const gravity_curve_t* curve, int linesCleared) {
+    int level = linesCleared / curve->linesPerLevel;
+    if (level >= curve->nlevels) level = curve->nlevels - 1;
+    return curve->periodUs[level];
+}
+
+// Packs piece into its snapshot form (4 bytes; the piece's id is only meaningful within its set)
+packed_piece_t game_engine_pack_piece(const falling_piece_t* piece) {
+    packed_piece_t packed;
+    packed.id = piece->pieceT.id;
+    packed.rotation = piece->rotation;
+    packed.fallen = piece->fallen;
+    packed.x = piece->x;
+    packed.y = piece->y;
+    return packed;
+}
+
+// Rebuilds a falling piece of set from its snapshot form
+falling_piece_t game_engine_unpack_piece(const piece_set_t* set, packed_piece_t packed) {
+    falling_piece_t piece;
+    piece.pieceT = set->pieces[packed.id];
+    piece.rotation = packed.rotation;
+    piece.fallen = packed.fallen;
+    piece.x = packed.x;
+    piece.y = packed.y;
+    return piece;
+}
+
+// Saves state into snapshot (O(1): the board is shared, not copied)
+// A snapshot being reused must have been released first
+void game_engine_save(const game_state_t* state, game_snapshot_t* snapshot) {
+    snapshot->set = state->set;
+    board_share(&snapshot->board, &state->board);
+    snapshot->bag = state->bag;
+    snapshot->piece = game_engine_pack_piece(&state->piece);
+    snapshot->queue = state->queue;
+    snapshot->gameOver = state->gameOver;
+    snapshot->clearedCount = state->cleared.count;
+    for (int i = 0; i < state->cleared.count; i++) snapshot->clearedRows[i] = state->cleared.rows[i];
+    snapshot->lockTopRow = state->lockTopRow;
+    snapshot->lockBottomRow = state->lockBottomRow;
+    snapshot->score = state->score;
+    snapshot->linesCleared = state->linesCleared;
+}
+
+// Puts state back the way it was when snapshot was saved (O(1)); the snapshot stays valid for further restores
+void game_engine_restore(game_state_t* state, const game_snapshot_t* snapshot) {
+    board_free(&state->board);
+    board_share(&state->board, &snapshot->board);
+    state->bag = snapshot->bag;
+    state->set = snapshot->set;
+    state->piece = game_engine_unpack_piece(snapshot->set, snapshot->piece);
+    state->queue = snapshot->queue;
+    state->gameOver = snapshot->gameOver;
+    state->cleared.count = snapshot->clearedCount;
+    for (int i = 0; i < snapshot->clearedCount; i++) state->cleared.rows[i] = snapshot->clearedRows[i];
+    state->lockTopRow = snapshot->lockTopRow;
+    state->lockBottomRow = snapshot->lockBottomRow;
+    state->score = snapshot->score;
+    state->linesCleared = snapshot->linesCleared;
+}
+
+// Drops the snapshot's reference to board storage
+void game_engine_release_snapshot(game_snapshot_t* snapshot) {
+    board_free(&snapshot->board);
+}
@@ -0,0 +1,220 @@
+#ifndef _GAME_ENGINE_H
+#define _GAME_ENGINE_H
+
+#include <stdbool.h>
+#include "gl.h"
+#include "board.h"
+#include "random_bag.h"
+
+/* Pieces live in a 5x5 grid (PIECE_GRID), so a piece can have up to 25 squares (tetrominoes sit in the top left
+4x4). The geometry of each piece in each rotation is generated at build time from the rotation masks
+(see host/gen_piece_sets.c and the generated piece_sets.c), so moving, drawing and collision checks never have to
+rediscover where a piece's squares are by bit scanning.
+For the 'j' tetromino config 0x44C0: cells = (1,0) (1,1) (0,2) (1,2), minCol = 0, maxCol = 1, minRow = 0, maxRow = 2,
+bottom = {2, 2, -1, -1, -1}
+*/
+#define PIECE_GRID 5
+#define PIECE_MAX_CELLS (PIECE_GRID * PIECE_GRID)
+
+typedef struct {
+    signed char cells[PIECE_MAX_CELLS][2];  // (col, row) of each square within the grid, in bit order
+    unsigned char ncells;                   // number of squares in the piece
+    unsigned char rowBits[PIECE_GRID];      // squares in each grid row, leftmost square in bit 0 (shifted into bitboard rows)
+    signed char bottom[PIECE_GRID];         // bottom profile: lowest occupied grid row of each column, -1 if column is empty
+    signed char minCol, maxCol;             // leftmost/rightmost occupied grid column
+    signed char minRow, maxRow;             // topmost/bottommost occupied grid row
+} piece_geometry_t;
+
+typedef struct {
+    char name;
+    color_t color;
+    unsigned int block_rotations[4];    // 25-bit mask of the 5x5 grid in each rotation (top left square is bit 24)
+    char id;                            // index of piece in its set
+    unsigned char square;               // palette index of the piece's squares on the board (see piece_set_t)
+    const piece_geometry_t* geometry;   // precomputed geometry of each rotation
+} piece_t;
+
+/* A set of pieces to play with, generated at build time. Board squares store a palette index (4 bits, see board.h),
+so a set has up to 15 colors; pieces may share colors, so sets can have any number of pieces (up to PIECE_SET_MAX).
+*/
+#define PIECE_SET_MAX 64
+
+typedef struct {
+    const char* name;
+    int npieces;
+    const piece_t* pieces;
+    color_t palette[16];                // color of each square value; palette[0] is the empty square
+} piece_set_t;
+
+extern const piece_set_t tetromino_set, pentomino_set;
+
+// The tetrominoes (tetromino_set)
+extern const piece_t i, j, l, o, s, t, z;
+extern const piece_t pieces[7];
+
+typedef struct {
+    piece_t pieceT;
+    char rotation;  // direction of rotation (0 through 3)
+    int x;
+    int y;
+    bool fallen;    // true/false to specify whether piece has fallen in its place
+} falling_piece_t;
+
+// Compact form of a falling piece for snapshots: the piece is just its id in the game's set (its piece_t is
+// constant data). x and y are stored in 7 and 16 bits, so game_engine_init asserts the board fits them.
+#define PACKED_PIECE_MAX_COLS 63
+#define PACKED_PIECE_MAX_ROWS 32767
+typedef struct {
+    unsigned int id : 6;
+    unsigned int rotation : 2;
+    unsigned int fallen : 1;
+    signed int x : 7;
+    signed int y : 16;
+} packed_piece_t;
+
+// Inputs applied by game_engine_step
+typedef enum {
+    INPUT_NONE = 0,
+    INPUT_LEFT,
+    INPUT_RIGHT,
+    INPUT_ROTATE,
+    INPUT_DOWN,         // one row down; a piece that can't move down locks (gravity tick)
+    INPUT_HARD_DROP,    // straight down to the landing row, then lock
+    INPUT_SWAP,         // swap falling piece with next piece
+} game_input_t;
+
+// Bitmask returned by game_engine_step describing what changed
+enum {
+    EVENT_MOVED     = 1 << 0,
+    EVENT_LOCKED    = 1 << 1,
+    EVENT_CLEARED   = 1 << 2,
+    EVENT_SPAWNED   = 1 << 3,
+    EVENT_GAME_OVER = 1 << 4,
+};
+
+/* Lookahead of upcoming pieces, dealt from the bag ahead of time and kept full: reading any of the next
+PIECE_QUEUE_SIZE pieces (preview, swap, placement search) is one array read and never touches the bag.
+*/
+#define PIECE_QUEUE_SIZE 8      // power of two, so ring indices wrap with a mask
+
+typedef struct {
+    unsigned char ids[PIECE_QUEUE_SIZE];    // ids in the game's set; slot head is the next piece
+    unsigned char head;
+} piece_queue_t;
+
+/* All state of one game. Nothing here draws or waits, and nothing is global (apart from the read-only piece tables),
+so any number of games can run in one process.
+*/
+typedef struct {
+    const piece_set_t* set;     // pieces this game is played with
+    int nrows;
+    int ncols;
+    board_t board;              // squares of fallen pieces (colors + bitboard row masks, see board.h)
+    bool bitboardMode;          // true -> collision tests use board row masks instead of per-square checks
+    int lockTopRow;             // range of rows touched by squares locked since the last clear
+    int lockBottomRow;
+    struct {
+        int rows[PIECE_GRID];       // rows emptied by the last clear, top to bottom; removed by game_engine_finish_clear
+        int count;
+    } cleared;
+    random_bag_t bag;
+    piece_queue_t queue;        // upcoming pieces (see game_engine_peek)
+    falling_piece_t piece;      // falling piece driven by game_engine_step
+    int score;
+    int linesCleared;
+    bool gameOver;
+} game_state_t;
+
+/* Snapshot of a game_state_t for undo, rollback and search (208 bytes on rv64, most of it the board_t and the bag).
+Taking or restoring one is O(1): the board is shared copy-on-write with the game (see board_share), so it is only
+copied if the game changes it afterwards.
+Snapshots hold a reference to board storage and must be released with game_engine_release_snapshot.
+*/
+typedef struct {
+    const piece_set_t* set;
+    board_t board;
+    random_bag_t bag;
+    packed_piece_t piece;
+    piece_queue_t queue;
+    bool gameOver;
+    signed char clearedCount;
+    short clearedRows[PIECE_GRID];
+    int lockTopRow;
+    int lockBottomRow;
+    int score;
+    int linesCleared;
+} game_snapshot_t;
+
+/* Gravity curve: time between gravity ticks for each level, with a new level every linesPerLevel lines cleared
+(levels past the end of the table stay at its last entry)
+*/
+typedef struct {
+    int linesPerLevel;
+    int nlevels;
+    const unsigned long* periodUs;
+} gravity_curve_t;
+
+extern const gravity_curve_t game_engine_default_gravity;
+
+// Board size of a game (compile-time constants in a STATIC_BOARD build, see board.h)
+#define GAME_NROWS(state) BOARD_NROWS(&(state)->board)
+#define GAME_NCOLS(state) BOARD_NCOLS(&(state)->board)
+
+void game_engine_init(game_state_t* state, int nrows, int ncols, unsigned int seed);
+
+void game_engine_init_with_set(game_state_t* state, const piece_set_t* set, int nrows, int ncols, unsigned int seed);
+
+void game_engine_free(game_state_t* state);
+
+const piece_geometry_t* game_engine_geometry(const falling_piece_t* piece);
+
+void game_engine_set_bitboard_mode(game_state_t* state, bool enabled);
+
+bool game_engine_is_valid_position(const game_state_t* state, falling_piece_t* piece);
+
+bool game_engine_has_fallen(const game_state_t* state, falling_piece_t* piece);
+
+int game_engine_landing_row(const game_state_t* state, falling_piece_t* piece);
+
+const piece_t* game_engine_peek(const game_state_t* state, int n);
+
+bool game_engine_spawn(game_state_t* state);
+
+bool game_engine_move(game_state_t* state, falling_piece_t* piece, int dx, int dy);
+
+bool game_engine_move_down_by(game_state_t* state, falling_piece_t* piece, int rows);
+
+bool game_engine_rotate(game_state_t* state, falling_piece_t* piece);
+
+bool game_engine_swap(game_state_t* state, falling_piece_t* piece);
+
+int game_engine_square_of(const piece_t* piece);
+
+void game_engine_set_square(game_state_t* state, int x, int y, int square);
+
+int game_engine_clear_rows(game_state_t* state);
+
+int game_engine_lock(game_state_t* state, falling_piece_t* piece);
+
+void game_engine_finish_clear(game_state_t* state);
+
+int game_engine_step(game_state_t* state, game_input_t input);
+
+unsigned long game_engine_gravity_us(const gravity_curve_t* curve, int linesCleared);
+
+packed_piece_t game_engine_pack_piece(const falling_piece_t* piece);
+
+falling_piece_t game_engine_unpack_piece(const piece_set_t* set, packed_piece_t packed);
+
+void game_engine_save(const game_state_t* state, game_snapshot_t* snapshot);
+
+void game_engine_restore(game_state_t* state, const game_snapshot_t* snapshot);
+
+void game_engine_release_snapshot(game_snapshot_t* snapshot);
+
+// Palette lookup for board squares (see game_engine_square_of): the color is only needed when drawing
+static inline color_t game_engine_square_color(const game_state_t* state, int square) {
+    return state->set->palette[square];
+}
+
+#endif
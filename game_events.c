@@ -0,0 +1,88 @@
+/* game_events.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The game_events.c module queues game events (see game_events.h) in a fixed-size ring and hands them to the
+* subscribers interested in each event type when the game loop dispatches them. Nothing is allocated; a full
+* queue drops the new event and counts it.
+*/
+
+#include "game_events.h"
+#include <stddef.h>
+
+static struct {
+    game_event_t queue[GAME_EVENT_QUEUE_SIZE];
+    unsigned int head;          // next event to dispatch
+    unsigned int tail;          // next free slot (head == tail -> empty)
+    unsigned long dropped;
+    struct {
+        unsigned int mask;
+        game_event_handler_t handler;
+        void *aux;
+    } subscribers[GAME_EVENT_MAX_SUBSCRIBERS];
+    int nsubscribers;
+} events;
+
+// Queues an event; returns false (and counts it as dropped) if the queue is full
+bool game_events_publish(game_event_type_t type, int count, int score) {
+    if (events.tail - events.head == GAME_EVENT_QUEUE_SIZE) {
+        events.dropped++;
+        return false;
+    }
+    game_event_t *event = &events.queue[events.tail & (GAME_EVENT_QUEUE_SIZE - 1)];
+    event->type = type;
+    event->count = count;
+    event->score = score;
+    events.tail++;
+    return true;
+}
+
+// Calls handler(event, aux) for every dispatched event whose GAME_EVENT_MASK(type) is in mask; subscribing the same
+// handler and aux again only replaces its mask, so it's safe to subscribe on every init
+// Returns false if there are already GAME_EVENT_MAX_SUBSCRIBERS subscribers
+bool game_events_subscribe(unsigned int mask, game_event_handler_t handler, void *aux) {
+    for (int i = 0; i < events.nsubscribers; i++) {
+        if (events.subscribers[i].handler == handler && events.subscribers[i].aux == aux) {
+            events.subscribers[i].mask = mask;
+            return true;
+        }
+    }
+    if (events.nsubscribers == GAME_EVENT_MAX_SUBSCRIBERS) return false;
+    events.subscribers[events.nsubscribers].mask = mask;
+    events.subscribers[events.nsubscribers].handler = handler;
+    events.subscribers[events.nsubscribers].aux = aux;
+    events.nsubscribers++;
+    return true;
+}
+
+// Hands every queued event to its subscribers, oldest first (including events subscribers publish meanwhile);
+// returns the number of events dispatched
+int game_events_dispatch(void) {
+    int dispatched = 0;
+    while (events.head != events.tail) {
+        game_event_t event = events.queue[events.head & (GAME_EVENT_QUEUE_SIZE - 1)];
+        events.head++;
+        for (int i = 0; i < events.nsubscribers; i++) {
+            if (events.subscribers[i].mask & GAME_EVENT_MASK(event.type)) {
+                events.subscribers[i].handler(&event, events.subscribers[i].aux);
+            }
+        }
+        dispatched++;
+    }
+    return dispatched;
+}
+
+int game_events_pending(void) {
+    return events.tail - events.head;
+}
+
+unsigned long game_events_dropped(void) {
+    return events.dropped;
+}
+
+// Empties the queue and removes all subscribers
+void game_events_reset(void) {
+    events.head = events.tail = 0;
+    events.dropped = 0;
+    events.nsubscribers = 0;
+}
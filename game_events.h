@@ -0,0 +1,42 @@
+#ifndef _GAME_EVENTS_H
+#define _GAME_EVENTS_H
+
+#include <stdbool.h>
+
+/* Deferred game events: the game publishes what happened into a bounded queue, and subscribers (haptics, audio,
+...) run when the game loop calls game_events_dispatch, outside of moving and locking pieces. A slow subscriber
+then delays one dispatch instead of stalling the game in the middle of a line clear.
+*/
+typedef enum {
+    GAME_EVENT_LOCKED = 0,      // a piece locked into the board
+    GAME_EVENT_LINES_CLEARED,   // count = rows cleared
+    GAME_EVENT_SWAP,            // falling piece swapped with the next piece
+    GAME_EVENT_GAME_OVER,
+    GAME_EVENT_NTYPES,
+} game_event_type_t;
+
+#define GAME_EVENT_MASK(type) (1u << (type))
+#define GAME_EVENT_QUEUE_SIZE 16        // power of two
+#define GAME_EVENT_MAX_SUBSCRIBERS 8
+
+typedef struct {
+    game_event_type_t type;
+    int count;
+    int score;                  // score when the event happened
+} game_event_t;
+
+typedef void (*game_event_handler_t)(const game_event_t *event, void *aux);
+
+bool game_events_publish(game_event_type_t type, int count, int score);
+
+bool game_events_subscribe(unsigned int mask, game_event_handler_t handler, void *aux);
+
+int game_events_dispatch(void);
+
+int game_events_pending(void);
+
+unsigned long game_events_dropped(void);
+
+void game_events_reset(void);
+
+#endif
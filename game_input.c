@@ -0,0 +1,95 @@
+/* game_input.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The game_input.c module turns held inputs into moves by time instead of by game loop iteration: a held direction
+* moves the piece once, then (after the delayed auto-shift) repeats at the auto-repeat rate, and a piece resting on
+* the stack locks once the lock delay is up. Callers pass in the current time, so the module never reads the timer
+* itself and plays the same whether the loop runs every 100 usec or every 10 ms.
+*/
+
+#include "game_input.h"
+
+// Defaults: moves repeat every 50 ms after a 170 ms hold, soft drop falls 50 rows a second, and a resting piece
+// has 250 ms (about half a gravity tick) to be tucked before it locks
+const input_timing_t game_input_default_timing = {
+    .dasUs = 170000,
+    .arrUs = 50000,
+    .softDropUs = 20000,
+    .lockDelayUs = 250000,
+};
+
+#define MAX_SHIFT 64    // cap on moves per call (wider than any board), for ARR 0 or a long stall
+
+// Required init: nothing held
+void game_input_init(input_state_t* input, const input_timing_t* timing) {
+    input->timing = *timing;
+    input->heldDir = 0;
+    input->nextShift = 0;
+    input->swapHeld = false;
+    input->dropHeld = false;
+    input->nextDrop = 0;
+    input->resting = false;
+    input->restingSince = 0;
+}
+
+// Returns how many squares to move in direction dir (-1 left, 1 right, 0 nothing held) at time nowUs:
+// 1 when dir is first pressed, then after the DAS one move per ARR interval that has passed since the last call
+int game_input_shift(input_state_t* input, int dir, unsigned long nowUs) {
+    if (dir != input->heldDir) {
+        input->heldDir = dir;
+        input->nextShift = nowUs + input->timing.dasUs;
+        return (dir != 0) ? 1 : 0;
+    }
+    if (dir == 0 || nowUs < input->nextShift) return 0;
+    if (input->timing.arrUs == 0) return MAX_SHIFT;
+
+    int moves = 1 + (nowUs - input->nextShift) / input->timing.arrUs;
+    if (moves > MAX_SHIFT) moves = MAX_SHIFT;
+    input->nextShift += moves * input->timing.arrUs;
+    return moves;
+}
+
+// Returns true if the piece should swap: once per tilt, however long the tilt is held
+bool game_input_swap(input_state_t* input, bool held) {
+    bool pressed = held && !input->swapHeld;
+    input->swapHeld = held;
+    return pressed;
+}
+
+// Returns how many rows to soft drop at time nowUs: one right away, then one per softDropUs while held
+int game_input_soft_drop(input_state_t* input, bool held, unsigned long nowUs) {
+    if (!held) {
+        input->dropHeld = false;
+        return 0;
+    }
+    if (!input->dropHeld) {
+        input->dropHeld = true;
+        input->nextDrop = nowUs;
+    }
+    if (nowUs < input->nextDrop) return 0;
+
+    int rows = 1 + (nowUs - input->nextDrop) / input->timing.softDropUs;
+    if (rows > MAX_SHIFT) rows = MAX_SHIFT;
+    input->nextDrop += rows * input->timing.softDropUs;
+    return rows;
+}
+
+// Returns true once the piece has been resting on the stack for the lock delay. Lifting off the stack (e.g. moving
+// past a ledge) restarts the delay; moving along the stack doesn't, so a piece can't be kept from locking forever.
+bool game_input_lock_due(input_state_t* input, bool resting, unsigned long nowUs) {
+    if (!resting) {
+        input->resting = false;
+        return false;
+    }
+    if (!input->resting) {
+        input->resting = true;
+        input->restingSince = nowUs;
+    }
+    return nowUs - input->restingSince >= input->timing.lockDelayUs;
+}
+
+// Call when a new piece comes in: the lock delay starts over for it
+void game_input_piece_spawned(input_state_t* input) {
+    input->resting = false;
+}
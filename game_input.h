@@ -0,0 +1,42 @@
+#ifndef _GAME_INPUT_H
+#define _GAME_INPUT_H
+
+#include <stdbool.h>
+
+/* Timing of held inputs, in microseconds, so how the game plays doesn't depend on how fast the game loop spins
+(e.g. how long a sensor read takes): a faster loop only samples the inputs more often.
+*/
+typedef struct {
+    unsigned long dasUs;        // delayed auto-shift: how long a direction is held before the piece starts repeating
+    unsigned long arrUs;        // auto-repeat rate: time between repeated moves (0 -> straight to the wall)
+    unsigned long softDropUs;   // time per row while soft drop is held
+    unsigned long lockDelayUs;  // how long a piece can rest on the stack (and still be moved) before it locks
+} input_timing_t;
+
+extern const input_timing_t game_input_default_timing;
+
+// Input state of one player: what's held and since when
+typedef struct {
+    input_timing_t timing;
+    int heldDir;                // -1 left, 1 right, 0 none
+    unsigned long nextShift;    // time of the next auto-repeat move of heldDir
+    bool swapHeld;
+    bool dropHeld;
+    unsigned long nextDrop;     // time of the next soft drop row
+    bool resting;               // piece was resting on the stack at the last lock check
+    unsigned long restingSince;
+} input_state_t;
+
+void game_input_init(input_state_t* input, const input_timing_t* timing);
+
+int game_input_shift(input_state_t* input, int dir, unsigned long nowUs);
+
+bool game_input_swap(input_state_t* input, bool held);
+
+int game_input_soft_drop(input_state_t* input, bool held, unsigned long nowUs);
+
+bool game_input_lock_due(input_state_t* input, bool resting, unsigned long nowUs);
+
+void game_input_piece_spawned(input_state_t* input);
+
+#endif
@@ -10,7 +10,6 @@
 
 #include "console.h"
 #include "game_interlude.h"
-#include "malloc.h"
 #include "remote.h"
 #include "LSD6DS33.h"
 #include "timer.h"
@@ -30,8 +29,7 @@ void game_interlude_init(int nrows, int ncols, color_t text, color_t bg) {
     // console info
     console_init(nrows, ncols, text, bg);
     contents._ncols = ncols ;
-    contents._nrows = nrows ;
-    contents._leaderboard = malloc(LEADERBOARD_SIZE*sizeof(leaderboard_character_t)) ; // 3 chars per each leaderboard thing
+    contents._nrows = nrows ; // leaderboard lives in contents (static), so no allocation here
 
     for(int i = 0; i < LEADERBOARD_SIZE; i++) {
         contents._leaderboard[i]._initials[0] = '*' ; 
@@ -74,12 +72,11 @@ static void game_interlude_display_game_stats(unsigned int score, unsigned int l
 
 /* game_interlude_get_user_initials
  * @functionality uses a simple state machine to prompt and read 2 letters in a user's initials
- * @returns a char* of the user's initials
+ * @param initials buffer (3 chars) that receives the user's initials
  * how to use: Click button to iterate thru characters. Tilt remote down to confirm character. Characters loop from A-Z
  */
-static char* game_interlude_get_user_initials(void) {
+static void game_interlude_get_user_initials(char initials[3]) {
 
-    char *initials = malloc(3) ;
     initials[0] = '\0' ;
     initials[1] = '\0' ;
     initials[2] = '\0' ;
@@ -140,8 +137,6 @@ static char* game_interlude_get_user_initials(void) {
     // set it into user's initials to return
     initials[0] = ('A'+first_letter%26) ;
     initials[1] = ('A'+second_letter%26) ;
-
-    return initials ;
 }
 
 /* game_interlude_update_leaderboard
@@ -151,7 +146,8 @@ static void game_interlude_update_leaderboard(unsigned int score) {
 
     if (score >= contents._leaderboard[LEADERBOARD_SIZE-1]._score) {  // if the score is high enough for leaderboard
 
-        char* initials = game_interlude_get_user_initials() ; 
+        char initials[3] ;
+        game_interlude_get_user_initials(initials) ; 
 
         for(int i = LEADERBOARD_SIZE-1; i >= 0; i--) {
             if (score < contents._leaderboard[i]._score || i == 0) { // most recent tie will be at the top
@@ -171,7 +167,6 @@ static void game_interlude_update_leaderboard(unsigned int score) {
                 contents._leaderboard[i+1]._initials[2] = '\0' ; // just bc; why not! :)
                 contents._leaderboard[i+1]._score = score ;
 
-                free(initials) ; 
                 break ;
             }
         }
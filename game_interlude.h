@@ -11,7 +11,7 @@ typedef struct {
 typedef struct {
     int _nrows;
     int _ncols;
-    leaderboard_character_t* _leaderboard;
+    leaderboard_character_t _leaderboard[LEADERBOARD_SIZE];
 } interlude_contents_t;
 
 /* 'game_interlude_init'
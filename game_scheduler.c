@@ -0,0 +1,74 @@
+/* game_scheduler.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The game_scheduler.c module runs the game loop on fixed timesteps instead of spinning on the tick counter: each
+* game_task_t keeps its own period and due time, and the loop idles (wfi) until the next task is due.
+*/
+
+#include "game_scheduler.h"
+#include "timer.h"
+
+// Required init: first tick is due one period from nowUs
+void game_task_init(game_task_t* task, unsigned long periodUs, int maxCatchUp, unsigned long nowUs) {
+    task->periodUs = periodUs;
+    task->nextUs = nowUs + periodUs;
+    task->maxCatchUp = maxCatchUp;
+    task->runs = 0;
+    task->late = 0;
+    task->dropped = 0;
+}
+
+// Returns how many ticks of task to run at time nowUs (0 if none is due yet), at most maxCatchUp
+int game_task_due(game_task_t* task, unsigned long nowUs) {
+    if (nowUs < task->nextUs) return 0;
+    long behind = 1 + (nowUs - task->nextUs) / task->periodUs;
+    task->nextUs += behind * task->periodUs;
+    task->late += behind - 1;
+    if (behind > task->maxCatchUp) {
+        task->dropped += behind - task->maxCatchUp;
+        task->late -= behind - task->maxCatchUp;
+        behind = task->maxCatchUp;
+    }
+    task->runs += behind;
+    return behind;
+}
+
+// Changes task's period from its next tick on (e.g. gravity speeding up); the tick already scheduled moves
+// so it's one new period after the last tick
+void game_task_set_period(game_task_t* task, unsigned long periodUs) {
+    task->nextUs = task->nextUs - task->periodUs + periodUs;
+    task->periodUs = periodUs;
+}
+
+// Returns the time the first of tasks is due
+unsigned long game_tasks_next_due(game_task_t* const tasks[], int ntasks) {
+    unsigned long due = tasks[0]->nextUs;
+    for (int i = 1; i < ntasks; i++) {
+        if (tasks[i]->nextUs < due) due = tasks[i]->nextUs;
+    }
+    return due;
+}
+
+// Idles until time dueUs. With sleep set, the CPU waits for interrupts (wfi) in between checks of the time, so
+// sleep needs an interrupt that fires regularly (e.g. the timer wheel's tick, see timer_wheel.h); otherwise it
+// spins on the timer.
+void game_scheduler_idle_until(unsigned long dueUs, bool sleep) {
+    while (timer_get_ticks() / TICKS_PER_USEC < dueUs) {
+#ifdef __riscv
+        if (sleep) __asm__ volatile ("wfi");
+#endif
+    }
+}
+
+// Returns the CPU's cycle counter, for measuring how long short pieces of work take (the timer only counts at
+// TICKS_PER_USEC). Off the device, where there's no cycle counter to read, timer ticks stand in for cycles.
+unsigned long game_scheduler_cycles(void) {
+#ifdef __riscv
+    unsigned long cycles;
+    __asm__ volatile ("csrr %0, mcycle" : "=r"(cycles));
+    return cycles;
+#else
+    return timer_get_ticks();
+#endif
+}
@@ -0,0 +1,33 @@
+#ifndef _GAME_SCHEDULER_H
+#define _GAME_SCHEDULER_H
+
+#include <stdbool.h>
+
+/* Fixed-timestep tasks for the game loop (gravity, input polling, rendering). Each task ticks every periodUs on
+its own schedule; a loop iteration asks each task how many ticks are due, runs them, then idles until the next
+task is due. Ticks keep their phase (tick n is due at start + n * period however late the loop gets to it), late
+ticks are caught up to maxCatchUp at a time, and ticks beyond that are dropped -- either way they're counted,
+never lost silently.
+*/
+typedef struct {
+    unsigned long periodUs;
+    unsigned long nextUs;       // time the next tick is due
+    int maxCatchUp;             // most ticks run by one game_task_due call
+    unsigned long runs;         // ticks run
+    unsigned long late;         // ticks run after the next one was already due
+    unsigned long dropped;      // ticks skipped because the task was more than maxCatchUp ticks behind
+} game_task_t;
+
+void game_task_init(game_task_t* task, unsigned long periodUs, int maxCatchUp, unsigned long nowUs);
+
+int game_task_due(game_task_t* task, unsigned long nowUs);
+
+void game_task_set_period(game_task_t* task, unsigned long periodUs);
+
+unsigned long game_tasks_next_due(game_task_t* const tasks[], int ntasks);
+
+void game_scheduler_idle_until(unsigned long dueUs, bool sleep);
+
+unsigned long game_scheduler_cycles(void);
+
+#endif
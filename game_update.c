@@ -4,132 +4,184 @@
 * 
 * The game_update.c module consists of all the architecture and functions 
 * underlying our game of Tetris, layering on top of the gl.c and fb.c modules.
+* The rules of the game live in game_engine.c; this module runs one game_state_t on screen, drawing the result
+* of each move and animating line clears.
 */
 
 #include "game_update.h"
+#include "game_engine.h"
+#include "board.h"
 #include "malloc.h"
 #include "strings.h"
 #include "printf.h"
 #include "timer.h"
 #include "remote.h"
 #include "uart.h"
-#include "random_bag.h"
 #include "passive_buzz_intr.h"
 #include "LSD6DS33.h"
 #include "console.h"
-
-/* Define the 7 Tetris pieces as piece_t structs, laying out their name, color, and rotational configurations
-Rotational configs are stored as hex numbers (bit representations). 
-Here's an example of how it works for one 'j' piece configuration: 0x44C0 which is 0100 0100 1100 0000 in binary                                                                           
-       8       4      2     1
-    +------+------+------+------+
- 0  |      |      |      |      |
-    |      |   *  |      |      |     
-    +------+------+------+------+
- 1  |      |      |      |      |
-    |      |   *  |      |      |     
-    +------+------+------+------+
- 2  |      |      |      |      |
-    |  *   |   *  |      |      |     
-    +------+------+------+------+
- 3  |      |      |      |      |
-    |      |      |      |      |     
-    +------+------+------+------+
-This setup supports iterating through the piece squares in a super fast and space-efficient manner! :)
-*/
-const piece_t i = {'i', 0x1AE6DC, {0x0F00, 0x2222, 0x00F0, 0x4444}};
-const piece_t j = {'j', 0x0000E4, {0x44C0, 0x8E00, 0x6440, 0x0E20}};
-const piece_t l = {'l', 0xEA9B11, {0x4460, 0x0E80, 0xC440, 0x2E00}};
-const piece_t o = {'o', 0xE5E900, {0x6600, 0x6600, 0x6600, 0x6600}};
-const piece_t s = {'s', 0x03E800, {0x06C0, 0x8C40, 0x6C00, 0x4620}};
-const piece_t t = {'t', 0x9305E2, {0x0E40, 0x4C40, 0x4E00, 0x4640}};
-const piece_t z = {'z', 0xE80201, {0x0C60, 0x4C80, 0xC600, 0x2640}};
-
-const piece_t pieces[7] = {i, j, l, o, s, t, z};
-piece_t nextFallingPiece;  
+#include "game_events.h"
+#include "autoplayer.h"
+#include "replay.h"
+
+// Private helpers, declared ahead of their first use
+static void drawFallingPiece(falling_piece_t* piece);
+static void finishClear(void);
+static void drawGhostPiece(falling_piece_t* piece);
+static void drawBoard(void);
+static void countSearch(void);
+static void drawHintPiece(falling_piece_t* piece);
+static unsigned long inputTick(void);
+static void recordInput(replay_input_t input);
+
+static game_state_t game;       // the game being played on screen
+static const piece_set_t* pieceSet = &tetromino_set;   // pieces used by the next game (game_update_set_piece_set)
+static struct {
+    bool given;             // true -> next game deals its pieces from seed (game_update_set_seed) instead of the timer
+    unsigned int seed;
+} nextSeed;
 
 static struct {
-    int nrows;
-    int ncols;
     color_t bg_col;
-    void* background_tracker; 
-    int gameScore;
-    int numLinesCleared; 
-    bool gameOver;
+    struct {
+        int phase;                  // CLEAR_IDLE, CLEAR_FLASH or CLEAR_BLANK (rows being cleared are in game.cleared)
+        unsigned long phaseStart;   // ticks when current phase began
+    } clearAnim;
 } game_config;
 
+/* Frame being built: moves, swaps and animation steps only update the game and mark the frame dirty, and
+game_update_render draws it, so a game loop iteration that moves the piece several times renders once. Without
+deferred rendering (game_update_set_deferred_render) every change is still drawn right away.
+*/
+static struct {
+    bool deferred;
+    bool dirty;                 // game changed since the last frame was drawn
+    bool showPiece;             // false -> board only (line clear animation)
+    falling_piece_t piece;      // falling piece to draw
+    unsigned long needed;       // frames requested by game changes (each one used to be a full redraw)
+    unsigned long rendered;     // frames actually drawn and swapped
+} frame;
+
+/* Anytime placement search for the falling piece (see autoplayer.h), run by the game loop in slices of its idle
+time (game_update_search_run). Its best move so far is drawn as a hint outline, or played by game_update_autoplay.
+*/
+static struct {
+    bool enabled;
+    bool initialized;           // player has its boards (set up by the first game_update_init with search enabled)
+    autoplayer_t player;
+    autoplay_task_t task;
+    bool showHint;
+    falling_piece_t hint;       // the piece that would lock (the next piece for a swap) at the best placement
+    unsigned long pieces;       // pieces searched since game_update_init
+    unsigned long nodes;        // boards evaluated for them
+    unsigned long slices;
+    unsigned long cycles;       // cycles spent in those slices
+    unsigned long maxSliceCycles;
+} search;
+
+// Replay of the game being played (see replay.h): its seed and every input that changed it
+static struct {
+    replay_t replay;
+    unsigned long start;        // ticks when the game started
+} record;
+
+// Ring of the most recent snapshots of the game (for undo); saving over a full ring drops the oldest snapshot
+#define SNAPSHOT_RING_SIZE 16
+static struct {
+    game_snapshot_t slots[SNAPSHOT_RING_SIZE];
+    int newest;     // slot of most recent snapshot
+    int count;
+} snapshots;
+
+// Line clear animation: cleared rows flash white, then show empty, then the rows above drop down
+enum { CLEAR_IDLE = 0, CLEAR_FLASH, CLEAR_BLANK };
+#define CLEAR_PHASE_MS 250
+
 const unsigned int SQUARE_DIM = 20;  // game square dimensions in pixels
+#define PREVIEW_COUNT 3                 // upcoming pieces shown in the top right corner (up to PIECE_QUEUE_SIZE)
+
+#define CLEAR_VIBRATE_MS 2000     // remote vibration per row cleared
+
+// Line clear haptics (game event subscriber): runs from game_events_dispatch, and vibrates in the background
+static void vibrateOnClear(const game_event_t* event, void* aux) {
+    remote_vibrate_async(CLEAR_VIBRATE_MS * event->count);
+}
+
+// Line clear audio (game event subscriber): music speeds up for every row cleared
+static void speedUpOnClear(const game_event_t* event, void* aux) {
+    buzzer_intr_set_tempo(buzzer_intr_get_tempo() + 2 * event->count);
+}
 
 // Required init 
 void game_update_init(int nrows, int ncols) {
-    if (game_config.background_tracker != NULL) free(game_config.background_tracker);
-    game_config.nrows = nrows;
-    game_config.ncols = ncols;
+    // subscribed on every init (a repeat subscription is a no-op), so a game_events_reset doesn't lose them
+    game_events_subscribe(GAME_EVENT_MASK(GAME_EVENT_LINES_CLEARED), vibrateOnClear, NULL);
+    game_events_subscribe(GAME_EVENT_MASK(GAME_EVENT_LINES_CLEARED), speedUpOnClear, NULL);
+    game_update_clear_snapshots();
+    if (game.board.cells != NULL) game_engine_free(&game);
+    unsigned int seed = nextSeed.given ? nextSeed.seed : timer_get_ticks();
+    nextSeed.given = false;
+    game_engine_init_with_set(&game, pieceSet, nrows, ncols, seed);
+    replay_init(&record.replay, &game, seed);
+    record.start = timer_get_ticks();
     game_config.bg_col = GL_INDIGO;
-    game_config.gameScore = 0;
-    game_config.numLinesCleared = 0;
-    game_config.gameOver = false;
-
-    int gridSize = game_config.nrows * game_config.ncols;
-    game_config.background_tracker = malloc(gridSize * sizeof(color_t));
-    memset(game_config.background_tracker, 0, gridSize * sizeof(color_t));
-
-    random_bag_init();
-    nextFallingPiece = pieces[random_bag_choose()];
-    gl_init(game_config.ncols * SQUARE_DIM, game_config.nrows * SQUARE_DIM, GL_DOUBLEBUFFER);
+    game_config.clearAnim.phase = CLEAR_IDLE;
+    frame.dirty = false;
+    frame.needed = frame.rendered = 0;
+    autoplayer_task_stop(&search.task);
+    search.task.slices = 0;
+    search.showHint = false;
+    search.pieces = search.nodes = search.slices = search.cycles = search.maxSliceCycles = 0;
+    if (search.initialized) autoplayer_free(&search.player);
+    search.initialized = search.enabled;
+    if (search.enabled) autoplayer_init(&search.player, nrows, ncols, &autoplay_default_weights, 1, 1);
+
+    gl_init(GAME_NCOLS(&game) * SQUARE_DIM, GAME_NROWS(&game) * SQUARE_DIM, GL_DOUBLEBUFFER);
     gl_clear(game_config.bg_col);
     gl_swap_buffer();
 }
 
-// Required init to construct and obtain a new falling piece
-// Falling piece type is selected from the elements remaining in random bag
-falling_piece_t init_falling_piece(void) {
-    draw_background();
-
-    falling_piece_t piece;
-    piece.pieceT = nextFallingPiece;
-    nextFallingPiece = pieces[random_bag_choose()];
-    piece.rotation = 0;
+// Helper to get the input tick (REPLAY_TICK_US) of the game's replay it is now
+static unsigned long inputTick(void) {
+    return (timer_get_ticks() - record.start) / (REPLAY_TICK_US * TICKS_PER_USEC);
+}
 
-    // Subtract half of each piece's 4x4 grid width from the board's center x-coordinate
-    // (Representing each piece config as a hex value / bit sequence denotes the squares filled within a 4 x 4 grid) 
-    piece.x = (game_config.ncols / 2) - 2;
-    piece.y = 0;
-    piece.fallen = false;
+// Helper to add an input that changed the game to its replay
+static void recordInput(replay_input_t input) {
+    replay_record(&record.replay, input, inputTick());
+}
 
-    // End game if new piece drawn from random bag is not valid (coordinates out of bounds); otherwise, return chosen piece
-    if (!iterateThroughPieceSquares(&piece, checkIfValidMove)) endGame();
-    else {
-        iterateThroughPieceSquares(&piece, drawFallingSquare);
-        gl_swap_buffer();
-    }
-    return piece;
+// Selects the pieces the game is played with, from the next game_update_init on (Tetris pieces by default)
+void game_update_set_piece_set(const piece_set_t* set) {
+    pieceSet = set;
 }
 
-// Helper function to check if swap attempt is valid; returns true/false
-static bool isSwapValid(falling_piece_t piece) {
-    falling_piece_t swapPiece;
-    swapPiece.pieceT = nextFallingPiece;
-    swapPiece.rotation = piece.rotation;
-    swapPiece.x = piece.x;
-    swapPiece.y = piece.y;
-    swapPiece.fallen = false;
+// Makes the next game_update_init deal its pieces from seed, e.g. the game_update_get_seed of an earlier game to
+// play (or benchmark) the same piece sequence again
+void game_update_set_seed(unsigned int seed) {
+    nextSeed.given = true;
+    nextSeed.seed = seed;
+}
 
-    if (iterateThroughPieceSquares(&swapPiece, checkIfValidMove)) return true;
-    return false;
+// Required init to construct and obtain a new falling piece
+// Falling piece type is selected from the elements remaining in random bag
+falling_piece_t init_falling_piece(void) {
+    // new piece can't spawn over rows that haven't dropped yet; spawning finishes any line clear animation right away
+    game_config.clearAnim.phase = CLEAR_IDLE;
+    search.showHint = false;
+
+    // End game if new piece drawn from random bag is not valid (coordinates out of bounds); otherwise, draw chosen piece
+    if (!game_engine_spawn(&game)) endGame();
+    else drawPiece(&game.piece);
+    return game.piece;
 }
 
 // Swap function to swap current falling game piece with next queued piece
 void swap(falling_piece_t* piece) {
-    if (isSwapValid(*piece)) {
-        // make swap
-        piece_t curr = piece->pieceT;
-        piece->pieceT = nextFallingPiece;
-        nextFallingPiece = curr;
-
-        draw_background();
-        iterateThroughPieceSquares(piece, drawFallingSquare);
-        gl_swap_buffer();
+    if (game_engine_swap(&game, piece)) {
+        recordInput(REPLAY_SWAP);
+        game_events_publish(GAME_EVENT_SWAP, 0, game.score);
+        drawPiece(piece);
     }
 }
 
@@ -150,25 +202,14 @@ static void drawFallenSquare(int x, int y, color_t color) {
 }
 
 // This is the magical function that is frequently called to apply an action (taken in as a functionPtr) to 
-// each square in the tetris piece!  The coordinate locations of the squares are accessed using bitshifting!
+// each square in the tetris piece!  The coordinate locations of the squares come from the precomputed piece geometry
+// (generated at build time from the piece's rotation masks), so we visit exactly the squares of the piece.
 // If for any square in the tetris piece the action returns false, this function returns false and terminates.
 // If the action is successfully applied to all squares in the tetris piece, we return true.
 bool iterateThroughPieceSquares(falling_piece_t* piece, functionPtr action) {
-    int piece_config = (piece->pieceT).block_rotations[(int) piece->rotation];
-
-    // pieceRow and pieceCol will change from 0 through 3 during loop
-    // Indicates where on 4x4 piece grid we are checking
-    int pieceRow = 0; int pieceCol = 0;  
-    for (int bitSequence = 0x8000; bitSequence > 0; bitSequence = bitSequence >> 1) {
-        // if piece has a square in the 4x4 grid spot we're checking, perform action fn on that square
-        if (piece_config & bitSequence) {
-            if (!action(piece->x + pieceCol, piece->y + pieceRow, piece)) return false;
-        }
-        pieceCol++;
-        // move to next row in grid, reset pieceCol to 0
-        if (pieceCol == 4) {
-            pieceCol = 0; pieceRow++;
-        }
+    const piece_geometry_t* geom = game_engine_geometry(piece);
+    for (int cell = 0; cell < geom->ncells; cell++) {
+        if (!action(piece->x + geom->cells[cell][0], piece->y + geom->cells[cell][1], piece)) return false;
     }
     return true;
 }
@@ -177,24 +218,22 @@ bool iterateThroughPieceSquares(falling_piece_t* piece, functionPtr action) {
 static bool checkIfValidMove(int x, int y, falling_piece_t* piece) {
     // make sure (x, y) is in bounds
     if (x < 0 || y < 0) return false;
-    if (x >= game_config.ncols || y >= game_config.nrows) return false;
+    if (x >= GAME_NCOLS(&game) || y >= GAME_NROWS(&game)) return false;
 
     // make sure another piece is not there already
-    unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
-    if ((background[y][x]) != 0) return false;
+    if (board_get_square(&game.board, x, y) != BOARD_EMPTY) return false;
     return true;
 }
 
 // Input (x, y) is the top left coordinate of tetris square being drawn; 
 // function checks if square directly below is already filled --> if so, change falling piece state to fallen
 bool checkIfFallen(int x, int y, falling_piece_t* piece) {
-    if ((y + 1) >= game_config.nrows) {
+    if ((y + 1) >= GAME_NROWS(&game)) {
         piece->fallen = true;
         return true;
     }
     else {
-        unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
-        if (background[y + 1][x] != 0) {
+        if (board_get_square(&game.board, x, y + 1) != BOARD_EMPTY) {
             piece->fallen = true;
             return true;
         }
@@ -205,174 +244,422 @@ bool checkIfFallen(int x, int y, falling_piece_t* piece) {
 // Helper to draw square of FALLING tetris piece specified by top left coordinate (x, y) into 
 // framebuffer (handled by gl / fb modules)
 // Returns true always -- function only called after valid move is verified
+// (fallen state is updated by the engine after each move, not per square)
 static bool drawFallingSquare(int x, int y, falling_piece_t* piece) {
     gl_draw_rect(x * SQUARE_DIM, y * SQUARE_DIM, SQUARE_DIM, SQUARE_DIM, piece->pieceT.color);
     
     drawBevelLines(x, y, GL_WHITE);
-    checkIfFallen(x, y, piece);
     return true;
 }
 
-// Embeds square (of tetris piece) into background tracker
+// Embeds square (of tetris piece) into the board (palette index and bitboard mask)
 // Returns true always -- function only called after valid move is verified
 bool update_background(int x, int y, falling_piece_t* piece) {
-    unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
-    background[y][x] = piece->pieceT.color;
+    game_engine_set_square(&game, x, y, game_engine_square_of(&piece->pieceT));
     return true;
 }
 
+// Returns the row the piece would land on if dropped straight down from its current position
+int game_update_get_landing_row(falling_piece_t* piece) {
+    return game_engine_landing_row(&game, piece);
+}
+
+// Whole-piece check of whether the piece's current position is valid
+bool game_update_is_valid_position(falling_piece_t* piece) {
+    return game_engine_is_valid_position(&game, piece);
+}
+
+// Whole-piece check of whether the piece is resting on the stack (or ground); sets piece->fallen if so
+bool game_update_has_fallen(falling_piece_t* piece) {
+    return game_engine_has_fallen(&game, piece);
+}
+
+// Selects collision engine: true for bitboard row masks, false for per-square grid checks
+void game_update_set_bitboard_mode(bool enabled) {
+    game_engine_set_bitboard_mode(&game, enabled);
+}
+
 // Variant of iterateThroughPieceSquares; here, if the action returns true on any piece square, this function stops
 // and returns true. 
 // Used in game loop client (located in testing.c) to check if a piece has fallen and support the "tuck" feature  
 bool iterateVariant(falling_piece_t* piece, functionPtr action) {
-    int piece_config = (piece->pieceT).block_rotations[(int) piece->rotation];
-
-    // pieceRow and pieceCol will change from 0 through 3 during loop
-    // Indicates where on 4x4 piece grid we are checking
-    int pieceRow = 0; int pieceCol = 0;  
-    for (int bitSequence = 0x8000; bitSequence > 0; bitSequence = bitSequence >> 1) {
-        // if piece has a square in the 4x4 grid spot we're checking, perform action fn on that square
-        if (piece_config & bitSequence) {
-            if (action(piece->x + pieceCol, piece->y + pieceRow, piece)) return true;
-        }
-        pieceCol++;
-        // move to next row in grid, reset pieceCol to 0
-        if (pieceCol == 4) {
-            pieceCol = 0; pieceRow++;
-        }
+    const piece_geometry_t* geom = game_engine_geometry(piece);
+    for (int cell = 0; cell < geom->ncells; cell++) {
+        if (action(piece->x + geom->cells[cell][0], piece->y + geom->cells[cell][1], piece)) return true;
     }
     return false;
 }
 
 // Clears and redraws screen according to what's stored in the background tracker 
-// Called as prologue to every move/rotate function
+// Called as prologue to every frame (see game_update_render)
 static void draw_background(void) {
     gl_clear(game_config.bg_col);
-    unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
-    for (int y = 0; y < game_config.nrows; y++) {
-        for (int x = 0; x < game_config.ncols; x++) {
-            // if colored square in background (from fallen piece), draw
-            if (background[y][x] != 0) {
-                // gl_draw_rect(x * SQUARE_DIM, y * SQUARE_DIM, SQUARE_DIM, SQUARE_DIM, background[y][x]);
-                drawFallenSquare(x, y, background[y][x]);
-            }
+    for (int y = 0; y < GAME_NROWS(&game); y++) {
+        const unsigned char* row = board_row(&game.board, y);
+        for (int x = 0; x < GAME_NCOLS(&game); x += 2) {
+            // squares are packed two to a byte, so a pair of empty squares is skipped with one test
+            if (row[x >> 1] == 0) continue;
+            // if colored square in background (from fallen piece), draw it in its piece's color
+            int left = row[x >> 1] & 0x0F;
+            int right = row[x >> 1] >> 4;
+            if (left != BOARD_EMPTY) drawFallenSquare(x, y, game_engine_square_color(&game, left));
+            if (right != BOARD_EMPTY) drawFallenSquare(x + 1, y, game_engine_square_color(&game, right));
         }
     }
-    // Draw in top right corner the color of next piece to fall
-    gl_draw_rect((game_config.ncols - 1) * SQUARE_DIM, 0, SQUARE_DIM, SQUARE_DIM, nextFallingPiece.color);
+    // Flash rows that are being cleared
+    if (game_config.clearAnim.phase == CLEAR_FLASH) {
+        for (int i = 0; i < game.cleared.count; i++) {
+            gl_draw_rect(0, game.cleared.rows[i] * SQUARE_DIM, GAME_NCOLS(&game) * SQUARE_DIM, SQUARE_DIM, GL_WHITE);
+        }
+    }
+    // Draw in top right corner the color of next piece to fall, with the ones after it in smaller squares below
+    // (the queue is always full, so this is PREVIEW_COUNT reads whatever the game is doing)
+    int previewX = (GAME_NCOLS(&game) - 1) * SQUARE_DIM;
+    gl_draw_rect(previewX, 0, SQUARE_DIM, SQUARE_DIM, game_engine_peek(&game, 0)->color);
+    for (int n = 1; n < PREVIEW_COUNT; n++) {
+        gl_draw_rect(previewX + SQUARE_DIM / 4, SQUARE_DIM + (n - 1) * SQUARE_DIM / 2 + SQUARE_DIM / 8,
+                     SQUARE_DIM / 2, SQUARE_DIM / 2 - SQUARE_DIM / 8, game_engine_peek(&game, n)->color);
+    }
 
     // Draw score (top left of screen)
     char buf[20];
     int bufsize = sizeof(buf);
     memset(buf, '\0', bufsize);
-    snprintf(buf, bufsize, "SCORE %d", game_config.gameScore);
+    snprintf(buf, bufsize, "SCORE %d", game.score);
     gl_draw_string(0, 0, buf, GL_WHITE);
 }
 
-// Helper function to clear a single row, specified by the row number (y coordinate)
-static void clearRow(int row) {
-    unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
-    for (int col = 0; col < game_config.ncols; col++) {
-        background[row][col] = 0;
+// Helper to end the line clear animation by dropping the rows above the cleared rows into place
+static void finishClear(void) {
+    game_engine_finish_clear(&game);
+    game_config.clearAnim.phase = CLEAR_IDLE;
+}
+
+// Function to clear rows and update game score accordingly (see game_engine_clear_rows); called once the falling
+// piece is locked into the board
+// Filled rows are emptied and start the (non-blocking) clear animation: game loop must call game_update_advance_clear
+// until it returns true before spawning the next piece. Vibration and music run later, as subscribers of the
+// published events (game_events_dispatch).
+void clearRows(void) {
+    recordInput(REPLAY_LOCK);
+    int rowsFilled = game_engine_clear_rows(&game);
+    game_events_publish(GAME_EVENT_LOCKED, 0, game.score);
+    if (rowsFilled == 0) return;
+    game_events_publish(GAME_EVENT_LINES_CLEARED, rowsFilled, game.score);
+
+    game_config.clearAnim.phase = CLEAR_FLASH;
+    game_config.clearAnim.phaseStart = timer_get_ticks();
+    drawBoard();
+}
+
+// Advances the line clear animation started by clearRows; call once per game loop iteration while
+// game_update_is_clearing(). Returns true once the cleared rows are gone and play can continue.
+bool game_update_advance_clear(void) {
+    if (game_config.clearAnim.phase == CLEAR_IDLE) return true;
+    if (timer_get_ticks() - game_config.clearAnim.phaseStart < CLEAR_PHASE_MS * 1000 * TICKS_PER_USEC) return false;
+
+    if (game_config.clearAnim.phase == CLEAR_FLASH) {
+        game_config.clearAnim.phase = CLEAR_BLANK;
+        game_config.clearAnim.phaseStart = timer_get_ticks();
+        drawBoard();
+        return false;
     }
-    draw_background();
-    gl_swap_buffer();
-    timer_delay_ms(500);
+    finishClear();
+    drawBoard();
+    return true;
+}
 
-    for (int destRow = row; destRow > 0; destRow--) {
-        for (int col = 0; col < game_config.ncols; col++) {
-            background[destRow][col] = background[destRow - 1][col];
-        }
+// Returns whether a line clear animation is in progress
+bool game_update_is_clearing(void) {
+    return game_config.clearAnim.phase != CLEAR_IDLE;
+}
+
+// Helper to draw the squares of the falling piece (direct calls over the precomputed squares, no function pointer)
+static void drawFallingPiece(falling_piece_t* piece) {
+    const piece_geometry_t* geom = game_engine_geometry(piece);
+    for (int cell = 0; cell < geom->ncells; cell++) {
+        drawFallingSquare(piece->x + geom->cells[cell][0], piece->y + geom->cells[cell][1], piece);
+    }
+}
+
+// Helper to draw the ghost piece: an outline of the falling piece at the row it would land on
+static void drawGhostPiece(falling_piece_t* piece) {
+    int landing = game_engine_landing_row(&game, piece);
+    if (landing <= piece->y) return;
+    const piece_geometry_t* geom = game_engine_geometry(piece);
+    for (int cell = 0; cell < geom->ncells; cell++) {
+        int x = piece->x + geom->cells[cell][0];
+        int y = landing + geom->cells[cell][1];
+        drawBevelLines(x, y, piece->pieceT.color);
     }
-    // reset 1st row of background 
-    memset(background, 0, game_config.ncols * sizeof(color_t));
+}
+
+// Helper to draw the hint: an outline of the piece at the placement the search found best
+static void drawHintPiece(falling_piece_t* piece) {
+    const piece_geometry_t* geom = game_engine_geometry(piece);
+    for (int cell = 0; cell < geom->ncells; cell++) {
+        drawBevelLines(piece->x + geom->cells[cell][0], piece->y + geom->cells[cell][1], GL_WHITE);
+    }
+}
+
+// Draws the frame (background, then ghost and falling piece unless the frame is board only) if the game changed
+// since the last one; returns whether a frame was drawn. With deferred rendering the game loop calls this once per
+// frame, after applying all of that frame's inputs.
+bool game_update_render(void) {
+    if (!frame.dirty) return false;
     draw_background();
+    if (frame.showPiece) {
+        drawGhostPiece(&frame.piece);
+        if (search.showHint) drawHintPiece(&search.hint);
+        drawFallingPiece(&frame.piece);
+    }
     gl_swap_buffer();
+    frame.dirty = false;
+    frame.rendered++;
+    return true;
 }
 
-// Function to clear rows and update game score accordingly
-void clearRows(void) {
-    unsigned int (*background)[game_config.ncols] = game_config.background_tracker;
-    int rowsFilled = 0;
-    for (int row = 0; row < game_config.nrows; row++) {
-        bool rowFilled = true;
-        for (int col = 0; col < game_config.ncols; col++) {
-            // if we find an empty square, the row is not filled
-            if (background[row][col] == 0) {
-                rowFilled = false;
-                break;
-            }
-        }
-        if (rowFilled) {
-            clearRow(row); 
-            remote_vibrate(2); // remote_vibrate(rowsFilled + 1);
-            buzzer_intr_set_tempo(buzzer_intr_get_tempo() + 2) ;
-            game_config.numLinesCleared++ ;
-            rowsFilled++;
-        }
-    }
-    if (rowsFilled == 1) game_config.gameScore += 40;
-    else if (rowsFilled == 2) game_config.gameScore += 100;
-    else if (rowsFilled == 3) game_config.gameScore += 300;
-    else if (rowsFilled == 4) game_config.gameScore += 1200;
+// Helper to request a frame: the piece (if any) is copied, so the frame shows the game as of the last change
+static void requestFrame(const falling_piece_t* piece) {
+    frame.showPiece = (piece != NULL);
+    if (piece != NULL) frame.piece = *piece;
+    frame.dirty = true;
+    frame.needed++;
+    if (!frame.deferred) game_update_render();
 }
 
 // Helper to draw falling tetris piece
 static void drawPiece(falling_piece_t* piece) {
-    draw_background();
-    iterateThroughPieceSquares(piece, drawFallingSquare);
-    gl_swap_buffer();
+    requestFrame(piece);
+}
+
+// Helper to draw the board without a falling piece (line clear animation)
+static void drawBoard(void) {
+    requestFrame(NULL);
+}
+
+// true -> moves, swaps and animation steps only mark the frame dirty, and nothing is drawn until the game loop calls
+// game_update_render; false (default) -> every change is drawn right away
+void game_update_set_deferred_render(bool enabled) {
+    frame.deferred = enabled;
+    if (!enabled) game_update_render();
+}
+
+// Frame counters since game_update_init: frames the game's changes asked for, and frames actually drawn
+unsigned long game_update_get_frames_needed(void) {
+    return frame.needed;
+}
+
+unsigned long game_update_get_frames_rendered(void) {
+    return frame.rendered;
+}
+
+// true -> the next game_update_init sets up the placement search (hints and autopilot); off by default, since its
+// player takes a board of its own
+void game_update_set_search(bool enabled) {
+    search.enabled = enabled;
+}
+
+// Helper to fold the finished (or abandoned) search of the last piece into the per-game counters
+static void countSearch(void) {
+    if (search.task.slices == 0) return;
+    search.pieces++;
+    search.nodes += search.task.nodes;
+    search.slices += search.task.slices;
+    search.cycles += search.task.cycles;
+    if (search.task.maxSliceCycles > search.maxSliceCycles) search.maxSliceCycles = search.task.maxSliceCycles;
+    search.task.slices = 0;
+}
+
+// Starts searching for the best move of piece (the falling piece just spawned or swapped in); the hint of the last
+// piece is taken down
+void game_update_search_start(falling_piece_t* piece) {
+    if (!search.initialized) return;
+    countSearch();
+    search.showHint = false;
+    game.piece = *piece;
+    search.hint = *piece;
+    autoplayer_task_start(&search.player, &search.task, &game);
+}
+
+/* Runs the search for up to budgetUs (the game loop's idle time until its next task is due); returns true once the
+search for this piece is done. A finished search puts up its hint (drawn with the next frame).
+*/
+bool game_update_search_run(unsigned long budgetUs) {
+    if (!search.initialized || !search.task.active) return true;
+    if (!autoplayer_task_run(&search.player, &search.task, budgetUs)) return false;
+
+    autoplay_move_t move;
+    if (autoplayer_task_best(&search.task, &move)) {
+        if (move.swap) search.hint.pieceT = *game_engine_peek(&game, 0);
+        search.hint.x = move.placement.x;
+        search.hint.y = move.placement.y;
+        search.hint.rotation = move.placement.rotation;
+        search.showHint = true;
+        requestFrame(&frame.piece);
+    }
+    return true;
+}
+
+/* Autopilot: makes the search's best move so far with piece (swap, then move it to the placement), ready to be
+locked by the game loop. Returns false, leaving piece alone, if the search hasn't found a move yet or the move no
+longer fits (the piece was moved or swapped since the search started).
+*/
+bool game_update_autoplay(falling_piece_t* piece) {
+    autoplay_move_t move;
+    if (!search.initialized || !autoplayer_task_best(&search.task, &move)) return false;
+    falling_piece_t target = *piece;
+    if (move.swap) target.pieceT = *game_engine_peek(&game, 0);
+    target.x = move.placement.x;
+    target.y = move.placement.y;
+    target.rotation = move.placement.rotation;
+    if (!game_update_is_valid_position(&target)) return false;
+    if (move.swap) {
+        if (!game_engine_swap(&game, piece)) return false;
+        recordInput(REPLAY_SWAP);
+        game_events_publish(GAME_EVENT_SWAP, 0, game.score);
+        target.pieceT = piece->pieceT;
+    }
+    autoplayer_task_stop(&search.task);
+    search.showHint = false;
+    *piece = target;
+    game_engine_has_fallen(&game, piece);
+    replay_record_place(&record.replay, piece->x, piece->y, piece->rotation, inputTick());
+    drawPiece(piece);
+    return true;
+}
+
+// Search counters since game_update_init, for pieces whose search has been started and replaced
+unsigned long game_update_get_search_pieces(void) {
+    return search.pieces;
+}
+
+unsigned long game_update_get_search_nodes(void) {
+    return search.nodes;
+}
+
+// Slices the searches took, and their cycles: total and most in one slice
+unsigned long game_update_get_search_slices(void) {
+    return search.slices;
+}
+
+unsigned long game_update_get_search_cycles(void) {
+    return search.cycles;
+}
+
+unsigned long game_update_get_search_max_slice_cycles(void) {
+    return search.maxSliceCycles;
 }
 
 // These next functions are move and rotate functions which do nothing for an invalid move 
+// (the engine makes the move and updates the fallen state; these just draw the result)
 void move_down(falling_piece_t* piece) {
-    piece->y += 1;
-    if (!iterateThroughPieceSquares(piece, checkIfValidMove)) {
-        piece->y -= 1;
-        return;
-    };
-    drawPiece(piece);
+    if (game_engine_move(&game, piece, 0, 1)) {
+        recordInput(REPLAY_DOWN);
+        drawPiece(piece);
+    }
+}
+
+// Moves piece down up to `rows` rows (stopping where it lands) with a single redraw
+void move_down_by(falling_piece_t* piece, int rows) {
+    int from = piece->y;
+    if (game_engine_move_down_by(&game, piece, rows)) {
+        for (int row = from; row < piece->y; row++) recordInput(REPLAY_DOWN);
+        drawPiece(piece);
+    }
+}
+
+// Drops piece straight to its landing row: one redraw, and the piece is marked as fallen
+void hard_drop(falling_piece_t* piece) {
+    move_down_by(piece, GAME_NROWS(&game));
+    piece->fallen = true;
 }
 
 void move_left(falling_piece_t* piece) {
-    piece->x -= 1;
-    if (!iterateThroughPieceSquares(piece, checkIfValidMove)) {
-        piece->x += 1;
-        return;
-    };
-    drawPiece(piece);
+    if (game_engine_move(&game, piece, -1, 0)) {
+        recordInput(REPLAY_LEFT);
+        drawPiece(piece);
+    }
 }
 
 void move_right(falling_piece_t* piece) {
-    piece->x += 1;
-    if (!iterateThroughPieceSquares(piece, checkIfValidMove)) {
-        piece->x -= 1;
-        return;
-    };
-    drawPiece(piece);
+    if (game_engine_move(&game, piece, 1, 0)) {
+        recordInput(REPLAY_RIGHT);
+        drawPiece(piece);
+    }
 }
 
 void rotate(falling_piece_t* piece) {
-    char origRotation = piece->rotation;
-    piece->rotation = (origRotation + 1) % 4;
-    if (!iterateThroughPieceSquares(piece, checkIfValidMove)) {
-        piece->rotation = origRotation;
-        return;
-    };
+    if (game_engine_rotate(&game, piece)) {
+        recordInput(REPLAY_ROTATE);
+        drawPiece(piece);
+    }
+}
+
+// Saves the game (with piece as the falling piece) into the snapshot ring; O(1), the board isn't copied
+void game_update_save_snapshot(falling_piece_t* piece) {
+    game.piece = *piece;
+    int slot = (snapshots.newest + 1) % SNAPSHOT_RING_SIZE;
+    if (snapshots.count == SNAPSHOT_RING_SIZE) game_engine_release_snapshot(&snapshots.slots[slot]);
+    else snapshots.count++;
+    game_engine_save(&game, &snapshots.slots[slot]);
+    snapshots.newest = slot;
+}
+
+// Restores the game to the most recent snapshot (removing it from the ring) and redraws; piece is set to the
+// falling piece at that time. Returns false if there is no snapshot to go back to.
+bool game_update_undo(falling_piece_t* piece) {
+    if (snapshots.count == 0) return false;
+    game_snapshot_t* snapshot = &snapshots.slots[snapshots.newest];
+    game_engine_restore(&game, snapshot);
+    game_engine_release_snapshot(snapshot);
+    snapshots.newest = (snapshots.newest + SNAPSHOT_RING_SIZE - 1) % SNAPSHOT_RING_SIZE;
+    snapshots.count--;
+    record.replay.complete = false;     // a replay only goes forward
+
+    // rows of a clear in progress at save time drop right away
+    if (game.cleared.count > 0) finishClear();
+    game_config.clearAnim.phase = CLEAR_IDLE;
+    *piece = game.piece;
     drawPiece(piece);
+    return true;
+}
+
+// Drops all snapshots in the ring
+void game_update_clear_snapshots(void) {
+    while (snapshots.count > 0) {
+        game_engine_release_snapshot(&snapshots.slots[snapshots.newest]);
+        snapshots.newest = (snapshots.newest + SNAPSHOT_RING_SIZE - 1) % SNAPSHOT_RING_SIZE;
+        snapshots.count--;
+    }
 }
 
 // Getters 
 int game_update_get_rows_cleared(void) {
-    return game_config.numLinesCleared;
+    return game.linesCleared;
 }
 
 int game_update_get_score(void) {
-    return game_config.gameScore;
+    return game.score;
+}
+
+unsigned int game_update_get_seed(void) {
+    return random_bag_seed(&game.bag);
 }
 
 bool game_update_is_game_over(void) {
-    return game_config.gameOver;
+    return game.gameOver;
+}
+
+// Returns the replay of the game; a game that isn't over yet has its replay finished as it stands (nothing more is
+// recorded after that)
+const replay_t* game_update_get_replay(void) {
+    replay_finish(&record.replay, &game);
+    return &record.replay;
+}
+
+bool game_update_is_filled(int x, int y) {
+    return board_get_square(&game.board, x, y) != BOARD_EMPTY;
 }
 
 // Draw game start screen
@@ -437,15 +724,20 @@ void startGame(void) {
 
 }
 
-// End game screen
+// End game screen (drawn right away, and replaces any frame not rendered yet)
 void endGame(void) {
+    frame.dirty = false;
+    replay_finish(&record.replay, &game);
+    autoplayer_task_stop(&search.task);
+    countSearch();
     draw_background();
     char buf[20];
     int bufsize = sizeof(buf);
     snprintf(buf, bufsize, " GAME OVER ");
-    gl_draw_string(SQUARE_DIM, game_config.ncols / 2 * SQUARE_DIM, buf, GL_WHITE);
+    gl_draw_string(SQUARE_DIM, GAME_NCOLS(&game) / 2 * SQUARE_DIM, buf, GL_WHITE);
     gl_swap_buffer();
-    game_config.gameOver = true;
+    game.gameOver = true;
+    game_events_publish(GAME_EVENT_GAME_OVER, 0, game.score);
 }
 
 // uart-driven pause function - helpful for testing purposes
@@ -3,29 +3,17 @@
 
 #include <stdbool.h>
 #include "gl.h"
-
-typedef struct {
-    char name;
-    color_t color;
-    int block_rotations[4];
-} piece_t;
-
-extern const piece_t i, j, l, o, s, t, z;
-extern const piece_t pieces[7];
-extern piece_t nextFallingPiece;
-
-typedef struct {
-    piece_t pieceT;
-    char rotation;  // direction of rotation (0 through 3)
-    int x;
-    int y;
-    bool fallen;    // true/false to specify whether piece has fallen in its place
-} falling_piece_t;
+#include "game_engine.h"
+#include "replay.h"
 
 falling_piece_t init_falling_piece(void);
 
 void game_update_init(int nrows, int ncols);
 
+void game_update_set_piece_set(const piece_set_t* set);
+
+void game_update_set_seed(unsigned int seed);
+
 typedef bool (*functionPtr)(int x, int y, falling_piece_t* piece); 
 
 bool iterateThroughPieceSquares(falling_piece_t* piece, functionPtr action);
@@ -46,6 +34,10 @@ void swap(falling_piece_t* piece);
 
 void move_down(falling_piece_t* piece);
 
+void move_down_by(falling_piece_t* piece, int rows);
+
+void hard_drop(falling_piece_t* piece);
+
 void move_left(falling_piece_t* piece);
 
 void move_right(falling_piece_t* piece);
@@ -56,6 +48,32 @@ bool checkIfFallen(int x, int y, falling_piece_t* piece);
 
 static void drawPiece(falling_piece_t* piece);
 
+bool game_update_render(void);
+
+void game_update_set_deferred_render(bool enabled);
+
+unsigned long game_update_get_frames_needed(void) ;
+
+unsigned long game_update_get_frames_rendered(void) ;
+
+void game_update_set_search(bool enabled);
+
+void game_update_search_start(falling_piece_t* piece);
+
+bool game_update_search_run(unsigned long budgetUs);
+
+bool game_update_autoplay(falling_piece_t* piece);
+
+unsigned long game_update_get_search_pieces(void) ;
+
+unsigned long game_update_get_search_nodes(void) ;
+
+unsigned long game_update_get_search_slices(void) ;
+
+unsigned long game_update_get_search_cycles(void) ;
+
+unsigned long game_update_get_search_max_slice_cycles(void) ;
+
 void endGame(void);
 
 void startGame(void);
@@ -64,12 +82,36 @@ void pause(const char *message);
 
 void clearRows(void);
 
+bool game_update_advance_clear(void);
+
+bool game_update_is_clearing(void);
+
 int game_update_get_rows_cleared(void) ;
 
 int game_update_get_score(void) ;
 
+unsigned int game_update_get_seed(void) ;
+
 bool game_update_is_game_over(void) ;
 
+const replay_t* game_update_get_replay(void) ;
+
+bool game_update_is_filled(int x, int y) ;
+
 bool iterateVariant(falling_piece_t* piece, functionPtr action);
 
+bool game_update_is_valid_position(falling_piece_t* piece);
+
+int game_update_get_landing_row(falling_piece_t* piece);
+
+bool game_update_has_fallen(falling_piece_t* piece);
+
+void game_update_set_bitboard_mode(bool enabled);
+
+void game_update_save_snapshot(falling_piece_t* piece);
+
+bool game_update_undo(falling_piece_t* piece);
+
+void game_update_clear_snapshots(void);
+
 #endif
\ No newline at end of file
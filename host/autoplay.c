@@ -0,0 +1,57 @@
+/* autoplay.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* Host (Linux) load generator and benchmark of the engine: the autoplayer (see autoplayer.h) plays seeded games of
+* the game's own rules (the 28-piece bag, swap, tucks, 40/100/300/1200 scoring) back to back as fast as it can,
+* and reports pieces placed per second, search nodes (boards evaluated) per second, and lines and score per game.
+* Build with `make host`, then run ./autoplay [games] [beam width] [depth] [max pieces per game]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "game_engine.h"
+#include "autoplayer.h"
+#include "timer.h"
+
+int main(int argc, char* argv[]) {
+    int ngames = (argc > 1) ? atoi(argv[1]) : 20;
+    int beamWidth = (argc > 2) ? atoi(argv[2]) : 8;
+    int depth = (argc > 3) ? atoi(argv[3]) : 2;
+    long maxPieces = (argc > 4) ? atol(argv[4]) : 2000;     // a good player may never top out
+
+    static autoplayer_t player;
+    autoplayer_init(&player, 20, 10, &autoplay_default_weights, beamWidth, depth);
+
+    long pieces = 0; long lines = 0; long score = 0; long toppedOut = 0;
+    long fewestLines = -1; long mostLines = 0;
+    unsigned long start = timer_get_ticks();
+    for (int g = 0; g < ngames; g++) {
+        game_state_t game;
+        game_engine_init(&game, 20, 10, 107 + g);
+        game_engine_spawn(&game);
+        long placed = 0;
+        while (!game.gameOver && placed < maxPieces) {
+            int events = autoplayer_play(&player, &game);
+            if (events & EVENT_LOCKED) placed++;
+        }
+        pieces += placed;
+        lines += game.linesCleared;
+        score += game.score;
+        if (game.gameOver) toppedOut++;
+        if (fewestLines < 0 || game.linesCleared < fewestLines) fewestLines = game.linesCleared;
+        if (game.linesCleared > mostLines) mostLines = game.linesCleared;
+        game_engine_free(&game);
+    }
+    unsigned long usecs = timer_get_ticks() - start;
+    if (usecs == 0) usecs = 1;
+
+    printf("%d games (beam %d, depth %d, up to %ld pieces each) in %lu usec, %ld topped out\n",
+           ngames, player.beamWidth, player.depth, maxPieces, usecs, toppedOut);
+    printf("%.0f pieces/sec, %.0f search nodes/sec (%.1f nodes per piece)\n", pieces * 1e6 / usecs,
+           player.nodes * 1e6 / usecs, (double)player.nodes / (player.searches ? player.searches : 1));
+    printf("%.1f lines/game (%ld to %ld), %.0f score/game, %.1f pieces/game\n", (double)lines / ngames,
+           fewestLines, mostLines, (double)score / ngames, (double)pieces / ngames);
+    autoplayer_free(&player);
+    return 0;
+}
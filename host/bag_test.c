@@ -0,0 +1,98 @@
+/* bag_test.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* Host (Linux) test of random_bag: for each bag policy, draws tens of millions of pieces and checks that
+* - the same seed deals the same sequence again,
+* - every piece is dealt equally often (within 1%, exactly for whole bags),
+* - no piece goes missing for longer than its policy allows (bags only),
+* and reports draws per second.
+* Build with `make host`, then run ./bag_test [draws per policy]; exits nonzero if a check fails.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "random_bag.h"
+#include "timer.h"
+
+static const char* policy_names[] = {"multi", "single", "history"};
+
+// Checks one policy dealing nelems elements; returns number of failed checks
+static int test_policy(bag_policy_t policy, int nelems, long draws) {
+    int failures = 0;
+    random_bag_t bag, replay;
+    random_bag_init_with_policy(&bag, 107, nelems, policy);
+    random_bag_init_with_policy(&replay, random_bag_seed(&bag), nelems, policy);
+    int bagSize = bag.size;
+
+    long counts[BAG_CAPACITY] = {0};
+    long lastSeen[BAG_CAPACITY];
+    long longestGap = 0;
+    for (int e = 0; e < nelems; e++) lastSeen[e] = -1;
+
+    // deterministic replay
+    for (long n = 0; n < 1000000; n++) {
+        if (random_bag_choose_from(&bag) != random_bag_choose_from(&replay)) {
+            printf("  FAIL: replay from seed %u differs at draw %ld\n", random_bag_seed(&bag), n);
+            failures++;
+            break;
+        }
+    }
+
+    // distribution and gaps between deals of the same element (fresh bag, so bags line up with draw 0)
+    random_bag_init_with_policy(&bag, 42, nelems, policy);
+    unsigned long start = timer_get_ticks();
+    for (long n = 0; n < draws; n++) {
+        int e = random_bag_choose_from(&bag);
+        counts[e]++;
+        if (n - lastSeen[e] > longestGap) longestGap = n - lastSeen[e];
+        lastSeen[e] = n;
+    }
+    unsigned long usecs = (timer_get_ticks() - start) / TICKS_PER_USEC;
+
+    double expected = (double)draws / nelems;
+    double worst = 0;
+    for (int e = 0; e < nelems; e++) {
+        double off = (counts[e] - expected) / expected;
+        if (off < 0) off = -off;
+        if (off > worst) worst = off;
+    }
+    if (worst > 0.01) {
+        printf("  FAIL: an element is dealt %.2f%% off its share\n", worst * 100);
+        failures++;
+    }
+    if (policy != BAG_POLICY_HISTORY) {
+        // whole bags deal each element exactly as often; across two bags an element is at most 2 * bagSize - 1 apart
+        if (draws % bagSize == 0) {
+            for (int e = 0; e < nelems; e++) {
+                if (counts[e] != counts[0]) {
+                    printf("  FAIL: element %d dealt %ld times, element 0 %ld times\n", e, counts[e], counts[0]);
+                    failures++;
+                    break;
+                }
+            }
+        }
+        if (longestGap > 2 * bagSize - 1 - (bagSize / nelems - 1)) {
+            printf("  FAIL: gap of %ld draws between deals of an element\n", longestGap);
+            failures++;
+        }
+    }
+
+    printf("%-7s bag, %2d elements: %ld draws in %lu usec (%.1f M draws/sec), worst share %.3f%% off, longest gap %ld\n",
+           policy_names[policy], nelems, draws, usecs, usecs ? (double)draws / usecs : 0.0, worst * 100, longestGap);
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    long draws = (argc > 1) ? atol(argv[1]) : 20000000;
+    draws -= draws % (28 * 12 * 7);     // whole bags for every policy and element count below
+    int failures = 0;
+    int sizes[] = {7, 12};
+    for (int s = 0; s < 2; s++) {
+        for (int policy = BAG_POLICY_MULTI; policy <= BAG_POLICY_HISTORY; policy++) {
+            failures += test_policy(policy, sizes[s], draws);
+        }
+    }
+    printf(failures ? "%d checks FAILED\n" : "all bag checks passed\n", failures);
+    return failures != 0;
+}
@@ -0,0 +1,87 @@
+/* engine_bench.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* Host (Linux) benchmark of the headless game engine: runs many games side by side in one process, feeding each
+* a pseudo-random stream of inputs, and reports raw engine throughput in steps per second. The boards the games
+* end up with are then used to time placement enumeration (see placement.h).
+* Build with `make host`, then run ./engine_bench [games] [steps per game]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "game_engine.h"
+#include "placement.h"
+#include "timer.h"
+
+// Input mix roughly like play: mostly sideways moves and rotations, with gravity ticks and the odd drop/swap
+static const game_input_t input_mix[16] = {
+    INPUT_LEFT, INPUT_LEFT, INPUT_RIGHT, INPUT_RIGHT, INPUT_ROTATE, INPUT_ROTATE, INPUT_NONE, INPUT_SWAP,
+    INPUT_DOWN, INPUT_DOWN, INPUT_DOWN, INPUT_DOWN, INPUT_DOWN, INPUT_DOWN, INPUT_HARD_DROP, INPUT_HARD_DROP,
+};
+
+int main(int argc, char* argv[]) {
+    int ngames = (argc > 1) ? atoi(argv[1]) : 64;
+    long steps = (argc > 2) ? atol(argv[2]) : 200000;
+#ifdef STATIC_BOARD
+    if (ngames > BOARD_POOL_SIZE) ngames = BOARD_POOL_SIZE;    // each game needs a board from the static pool
+#endif
+    game_state_t* games = malloc(ngames * sizeof(game_state_t));
+    for (int g = 0; g < ngames; g++) {
+        game_engine_init(&games[g], 20, 10, 107 + g);
+        game_engine_spawn(&games[g]);
+    }
+
+    unsigned int rng = 1;
+    long totalSteps = 0; long locks = 0; long lines = 0; long gamesPlayed = 0;
+    unsigned long start = timer_get_ticks();
+    for (long step = 0; step < steps; step++) {
+        for (int g = 0; g < ngames; g++) {
+            rng = rng * 1103515245 + 12345;
+            int events = game_engine_step(&games[g], input_mix[(rng >> 16) % 16]);
+            totalSteps++;
+            if (events & EVENT_LOCKED) locks++;
+            if (events & EVENT_GAME_OVER) {
+                // start a fresh game in the same slot
+                lines += games[g].linesCleared;
+                gamesPlayed++;
+                game_engine_free(&games[g]);
+                game_engine_init(&games[g], 20, 10, rng);
+                game_engine_spawn(&games[g]);
+            }
+        }
+    }
+    unsigned long usecs = timer_get_ticks() - start;
+
+    // every piece from where it spawns, on every game's board as play left it
+    placement_search_t search;
+    placement_init(&search, 20, 10);
+    placement_t* found = malloc(PLACEMENT_STATES(20, 10) * sizeof(placement_t));
+    long enumerations = 0; long placements = 0;
+    unsigned long placementStart = timer_get_ticks();
+    for (int round = 0; round < 100; round++) {
+        for (int g = 0; g < ngames; g++) {
+            for (int p = 0; p < 7; p++) {
+                falling_piece_t piece = {.pieceT = pieces[p], .rotation = 0, .x = 10 / 2 - 2, .y = 0, .fallen = false};
+                placements += placement_enumerate(&search, &games[g], &piece, found, PLACEMENT_STATES(20, 10));
+                enumerations++;
+            }
+        }
+    }
+    unsigned long placementUsecs = timer_get_ticks() - placementStart;
+    free(found);
+    placement_free(&search);
+
+    for (int g = 0; g < ngames; g++) {
+        lines += games[g].linesCleared;
+        game_engine_free(&games[g]);
+    }
+    free(games);
+
+    printf("%d games in parallel, %ld steps in %lu usec\n", ngames, totalSteps, usecs);
+    printf("%.0f steps/sec (%ld pieces locked, %ld lines cleared, %ld games finished)\n",
+           totalSteps * 1e6 / (usecs ? usecs : 1), locks, lines, gamesPlayed);
+    printf("%.0f placement enumerations/sec (%.1f placements each on average)\n",
+           enumerations * 1e6 / (placementUsecs ? placementUsecs : 1), (double)placements / enumerations);
+    return 0;
+}
@@ -0,0 +1,224 @@
+/* farm.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* Host (Linux) self-play farm: plays thousands of independent seeded games across all cores and aggregates their
+* score, lines and length. Every job is one game with its own seed and its own player: the autoplayer (heuristic)
+* or a pseudo-random input script. Jobs are spread over per-thread deques; a thread that runs out of jobs steals
+* half of another thread's remaining jobs.
+* The job set is run with 1, 2, 4, ... threads up to the number given, and each run has to reproduce the
+* single-thread results game for game: games share nothing but read-only tables, so any difference means shared
+* state. Reports games per second and the speedup over one thread.
+* Build with `make farm`, then run ./farm [games] [max threads] [bot|script] [max pieces per game]
+*/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "game_engine.h"
+#include "autoplayer.h"
+#include "timer.h"
+
+#ifdef STATIC_BOARD
+#error "the farm's games run in parallel, so boards have to come from the heap (build without STATIC_BOARD)"
+#endif
+
+typedef struct {
+    int score;
+    int lines;
+    int pieces;
+} job_result_t;
+
+// Jobs not yet run by a thread: game indices lo through hi - 1. The owner takes from the bottom, thieves from the top.
+typedef struct {
+    pthread_mutex_t lock;
+    int lo;
+    int hi;
+} job_deque_t;
+
+static struct {
+    int ngames;
+    int nthreads;
+    bool scripted;
+    int maxPieces;
+    job_deque_t* deques;
+    job_result_t* results;
+    long steals;
+} farm;
+
+// Input mix of the scripted player (as in engine_bench): mostly sideways moves and rotations, with gravity ticks
+static const game_input_t input_mix[16] = {
+    INPUT_LEFT, INPUT_LEFT, INPUT_RIGHT, INPUT_RIGHT, INPUT_ROTATE, INPUT_ROTATE, INPUT_NONE, INPUT_SWAP,
+    INPUT_DOWN, INPUT_DOWN, INPUT_DOWN, INPUT_DOWN, INPUT_DOWN, INPUT_DOWN, INPUT_HARD_DROP, INPUT_HARD_DROP,
+};
+
+// Plays game `job` to the end (or to maxPieces pieces) and records its result
+static void runJob(int job, autoplayer_t* player) {
+    game_state_t game;
+    unsigned int seed = 107 + job;
+    game_engine_init(&game, 20, 10, seed);
+    game_engine_spawn(&game);
+    int pieces = 0;
+    unsigned int rng = seed;
+    while (!game.gameOver && pieces < farm.maxPieces) {
+        int events;
+        if (farm.scripted) {
+            rng = rng * 1103515245 + 12345;
+            events = game_engine_step(&game, input_mix[(rng >> 16) % 16]);
+        } else {
+            events = autoplayer_play(player, &game);
+        }
+        if (events & EVENT_LOCKED) pieces++;
+    }
+    farm.results[job].score = game.score;
+    farm.results[job].lines = game.linesCleared;
+    farm.results[job].pieces = pieces;
+    game_engine_free(&game);
+}
+
+// Takes the next job of thread's own deque; -1 if it's empty
+static int takeJob(job_deque_t* deque) {
+    pthread_mutex_lock(&deque->lock);
+    int job = (deque->lo < deque->hi) ? deque->lo++ : -1;
+    pthread_mutex_unlock(&deque->lock);
+    return job;
+}
+
+// Moves the top half of the fullest other deque into thread's own deque; false if every deque is empty
+static bool stealJobs(int thread) {
+    int victim = -1, most = 0;
+    for (int t = 0; t < farm.nthreads; t++) {
+        if (t == thread) continue;
+        pthread_mutex_lock(&farm.deques[t].lock);
+        int left = farm.deques[t].hi - farm.deques[t].lo;     // may change before the steal: rechecked below
+        pthread_mutex_unlock(&farm.deques[t].lock);
+        if (left > most) {
+            victim = t;
+            most = left;
+        }
+    }
+    if (victim < 0) return false;
+
+    job_deque_t* from = &farm.deques[victim];
+    pthread_mutex_lock(&from->lock);
+    int left = from->hi - from->lo;
+    int lo = from->hi - (left + 1) / 2;
+    int hi = from->hi;
+    from->hi = lo;
+    pthread_mutex_unlock(&from->lock);
+    if (hi <= lo) return true;      // emptied meanwhile: look again
+
+    job_deque_t* to = &farm.deques[thread];
+    pthread_mutex_lock(&to->lock);
+    to->lo = lo;
+    to->hi = hi;
+    __atomic_add_fetch(&farm.steals, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&to->lock);
+    return true;
+}
+
+static void* worker(void* arg) {
+    int thread = (int)(long)arg;
+    autoplayer_t* player = NULL;
+    if (!farm.scripted) {
+        player = malloc(sizeof(autoplayer_t));
+        autoplayer_init(player, 20, 10, &autoplay_default_weights, 1, 1);
+    }
+    while (1) {
+        int job = takeJob(&farm.deques[thread]);
+        if (job >= 0) runJob(job, player);
+        else if (!stealJobs(thread)) break;
+    }
+    if (player != NULL) {
+        autoplayer_free(player);
+        free(player);
+    }
+    return NULL;
+}
+
+// Runs all games on nthreads threads; returns the wall time in microseconds
+static unsigned long runFarm(int nthreads) {
+    farm.nthreads = nthreads;
+    farm.steals = 0;
+    farm.deques = malloc(nthreads * sizeof(job_deque_t));
+    for (int t = 0; t < nthreads; t++) {
+        pthread_mutex_init(&farm.deques[t].lock, NULL);
+        farm.deques[t].lo = (long)farm.ngames * t / nthreads;
+        farm.deques[t].hi = (long)farm.ngames * (t + 1) / nthreads;
+    }
+    pthread_t* threads = malloc(nthreads * sizeof(pthread_t));
+    unsigned long start = timer_get_ticks();
+    for (int t = 0; t < nthreads; t++) pthread_create(&threads[t], NULL, worker, (void*)(long)t);
+    for (int t = 0; t < nthreads; t++) pthread_join(threads[t], NULL);
+    unsigned long usecs = timer_get_ticks() - start;
+    for (int t = 0; t < nthreads; t++) pthread_mutex_destroy(&farm.deques[t].lock);
+    free(threads);
+    free(farm.deques);
+    return usecs ? usecs : 1;
+}
+
+static int compareInts(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+// Prints mean, min, quartiles and max of one field of the results
+static void printDistribution(const char* name, int field) {
+    int* values = malloc(farm.ngames * sizeof(int));
+    long total = 0;
+    for (int g = 0; g < farm.ngames; g++) {
+        const job_result_t* result = &farm.results[g];
+        values[g] = (field == 0) ? result->score : (field == 1) ? result->lines : result->pieces;
+        total += values[g];
+    }
+    qsort(values, farm.ngames, sizeof(int), compareInts);
+    int n = farm.ngames - 1;
+    printf("  %-7s mean %9.1f  min %7d  p25 %7d  median %7d  p75 %7d  p90 %7d  max %7d\n", name,
+           (double)total / farm.ngames, values[0], values[n / 4], values[n / 2], values[3 * n / 4], values[9 * n / 10], values[n]);
+    free(values);
+}
+
+int main(int argc, char* argv[]) {
+    farm.ngames = (argc > 1) ? atoi(argv[1]) : 2000;
+    int maxThreads = (argc > 2) ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    farm.scripted = (argc > 3) && strcmp(argv[3], "script") == 0;
+    farm.maxPieces = (argc > 4) ? atoi(argv[4]) : 300;
+    if (farm.ngames < 1 || maxThreads < 1) {
+        fprintf(stderr, "usage: %s [games] [max threads] [bot|script] [max pieces per game]\n", argv[0]);
+        return 2;
+    }
+
+    job_result_t* reference = malloc(farm.ngames * sizeof(job_result_t));
+    farm.results = malloc(farm.ngames * sizeof(job_result_t));
+    printf("%d games, %s player, up to %d pieces each\n", farm.ngames, farm.scripted ? "scripted" : "greedy autoplayer",
+           farm.maxPieces);
+
+    unsigned long singleUsecs = 0;
+    int mismatches = 0;
+    for (int nthreads = 1; ; nthreads = (nthreads * 2 > maxThreads && nthreads < maxThreads) ? maxThreads : nthreads * 2) {
+        memset(farm.results, 0, farm.ngames * sizeof(job_result_t));
+        unsigned long usecs = runFarm(nthreads);
+        int differ = 0;
+        if (nthreads == 1) {
+            singleUsecs = usecs;
+            memcpy(reference, farm.results, farm.ngames * sizeof(job_result_t));
+        } else {
+            for (int g = 0; g < farm.ngames; g++) {
+                if (memcmp(&reference[g], &farm.results[g], sizeof(job_result_t)) != 0) differ++;
+            }
+        }
+        mismatches += differ;
+        printf("%3d threads: %8.0f games/sec, speedup %5.2fx, %ld steals, %d games differ from 1 thread\n", nthreads,
+               farm.ngames * 1e6 / usecs, (double)singleUsecs / usecs, farm.steals, differ);
+        if (nthreads >= maxThreads) break;
+    }
+
+    printf("distributions over %d games:\n", farm.ngames);
+    printDistribution("score", 0);
+    printDistribution("lines", 1);
+    printDistribution("pieces", 2);
+    free(reference);
+    free(farm.results);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,224 @@
+/* gen_piece_sets.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* Build-time generator for piece_sets.c: takes the piece sets (rotation masks and colors) defined below and prints
+* them as C, together with the geometry tables of every piece in every rotation, so the device never has to scan a
+* mask at run time. Run by the Makefile (`make piece_sets.c`) whenever this file changes.
+*
+* Every rotation of a piece is a 25-bit mask of a 5x5 grid, read row by row from the top left (bit 24) to the
+* bottom right (bit 0). Here's the 'j' tetromino config 0x44C0 (4x4) placed in the top left of a 5x5 grid:
+*       0      1      2      3      4
+*    +------+------+------+------+------+
+*  0 |      |  *   |      |      |      |
+*    +------+------+------+------+------+
+*  1 |      |  *   |      |      |      |
+*    +------+------+------+------+------+
+*  2 |  *   |  *   |      |      |      |
+*    +------+------+------+------+------+
+*  3 |      |      |      |      |      |
+*    +------+------+------+------+------+
+*  4 |      |      |      |      |      |
+*    +------+------+------+------+------+
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#define GRID 5
+#define MAX_PIECES 64
+
+typedef struct {
+    char name;
+    unsigned int color;
+    unsigned int rotations[4];      // 25-bit masks
+} piece_def_t;
+
+typedef struct {
+    const char* name;               // set is emitted as <name>_set
+    int npieces;
+    piece_def_t defs[MAX_PIECES];
+    unsigned int palette[16];       // palette[square]; 0 is the empty square
+    int square[MAX_PIECES];         // palette index of each piece
+} set_def_t;
+
+// Bit of grid square (row, col) in a 25-bit mask
+static unsigned int bitOf(int row, int col) {
+    return 1u << (GRID * GRID - 1 - (row * GRID + col));
+}
+
+// Converts one of the original 16-bit 4x4 configs to a 25-bit mask (piece keeps its place in the top left)
+static unsigned int fromMask4x4(unsigned int config) {
+    unsigned int mask = 0;
+    for (int row = 0; row < 4; row++) {
+        for (int col = 0; col < 4; col++) {
+            if (config & (0x8000 >> (row * 4 + col))) mask |= bitOf(row, col);
+        }
+    }
+    return mask;
+}
+
+// Builds a 25-bit mask from 5 strings of 5 characters ('#' = square)
+static unsigned int fromRows(const char* const rows[GRID]) {
+    unsigned int mask = 0;
+    for (int row = 0; row < GRID; row++) {
+        for (int col = 0; col < GRID; col++) {
+            if (rows[row][col] == '#') mask |= bitOf(row, col);
+        }
+    }
+    return mask;
+}
+
+// Rotates a mask a quarter turn clockwise about the center of the 5x5 grid
+static unsigned int rotateClockwise(unsigned int mask) {
+    unsigned int rotated = 0;
+    for (int row = 0; row < GRID; row++) {
+        for (int col = 0; col < GRID; col++) {
+            if (mask & bitOf(row, col)) rotated |= bitOf(col, GRID - 1 - row);
+        }
+    }
+    return rotated;
+}
+
+/* Tetrominoes: the original hand-placed 4x4 rotation configs and colors */
+static void defineTetrominoes(set_def_t* set) {
+    static const piece_def_t tetrominoes[7] = {
+        {'i', 0x1AE6DC, {0x0F00, 0x2222, 0x00F0, 0x4444}},
+        {'j', 0x0000E4, {0x44C0, 0x8E00, 0x6440, 0x0E20}},
+        {'l', 0xEA9B11, {0x4460, 0x0E80, 0xC440, 0x2E00}},
+        {'o', 0xE5E900, {0x6600, 0x6600, 0x6600, 0x6600}},
+        {'s', 0x03E800, {0x06C0, 0x8C40, 0x6C00, 0x4620}},
+        {'t', 0x9305E2, {0x0E40, 0x4C40, 0x4E00, 0x4640}},
+        {'z', 0xE80201, {0x0C60, 0x4C80, 0xC600, 0x2640}},
+    };
+    set->name = "tetromino";
+    set->npieces = 7;
+    for (int p = 0; p < 7; p++) {
+        set->defs[p] = tetrominoes[p];
+        for (int r = 0; r < 4; r++) set->defs[p].rotations[r] = fromMask4x4(tetrominoes[p].rotations[r]);
+        set->palette[p + 1] = tetrominoes[p].color;
+        set->square[p] = p + 1;
+    }
+}
+
+/* Pentominoes: the 12 free pentominoes, drawn about the center of the grid and rotated about it */
+static void definePentominoes(set_def_t* set) {
+    static const struct { char name; unsigned int color; const char* rows[GRID]; } pentominoes[12] = {
+        {'f', 0x1AE6DC, {".....", "..##.", ".##..", "..#..", "....."}},
+        {'i', 0xE80201, {"..#..", "..#..", "..#..", "..#..", "..#.."}},
+        {'l', 0xEA9B11, {"..#..", "..#..", "..#..", "..##.", "....."}},
+        {'n', 0x0000E4, {"...#.", "...#.", "..##.", "..#..", "....."}},
+        {'p', 0xE5E900, {".....", "..##.", "..##.", "..#..", "....."}},
+        {'t', 0x9305E2, {".....", ".###.", "..#..", "..#..", "....."}},
+        {'u', 0x03E800, {".....", ".#.#.", ".###.", ".....", "....."}},
+        {'v', 0xCB4899, {".....", ".#...", ".#...", ".###.", "....."}},
+        {'w', 0xF9D740, {".....", ".#...", ".##..", "..##.", "....."}},
+        {'x', 0x219756, {".....", "..#..", ".###.", "..#..", "....."}},
+        {'y', 0x7F7FFF, {"..#..", ".##..", "..#..", "..#..", "....."}},
+        {'z', 0xFF7F00, {".....", ".##..", "..#..", "..##.", "....."}},
+    };
+    set->name = "pentomino";
+    set->npieces = 12;
+    for (int p = 0; p < 12; p++) {
+        set->defs[p].name = pentominoes[p].name;
+        set->defs[p].color = pentominoes[p].color;
+        set->defs[p].rotations[0] = fromRows(pentominoes[p].rows);
+        for (int r = 1; r < 4; r++) set->defs[p].rotations[r] = rotateClockwise(set->defs[p].rotations[r - 1]);
+        set->palette[p + 1] = pentominoes[p].color;
+        set->square[p] = p + 1;
+    }
+}
+
+// Prints the geometry (see piece_geometry_t in game_engine.h) of one rotation mask
+static void printGeometry(unsigned int mask) {
+    int cells[GRID * GRID][2];
+    int ncells = 0;
+    unsigned int rowBits[GRID] = {0};
+    int bottom[GRID] = {-1, -1, -1, -1, -1};
+    int minCol = GRID - 1, maxCol = 0, minRow = GRID - 1, maxRow = 0;
+
+    for (int row = 0; row < GRID; row++) {
+        for (int col = 0; col < GRID; col++) {
+            if (!(mask & bitOf(row, col))) continue;
+            cells[ncells][0] = col;
+            cells[ncells][1] = row;
+            ncells++;
+            rowBits[row] |= 1u << col;
+            bottom[col] = row;  // rows scanned top to bottom, so last write is lowest
+            if (col < minCol) minCol = col;
+            if (col > maxCol) maxCol = col;
+            if (row < minRow) minRow = row;
+            if (row > maxRow) maxRow = row;
+        }
+    }
+
+    printf("        {.cells = {");
+    for (int cell = 0; cell < ncells; cell++) printf("%s{%d, %d}", cell ? ", " : "", cells[cell][0], cells[cell][1]);
+    printf("}, .ncells = %d,\n         .rowBits = {", ncells);
+    for (int row = 0; row < GRID; row++) printf("%s0x%02X", row ? ", " : "", rowBits[row]);
+    printf("}, .bottom = {");
+    for (int col = 0; col < GRID; col++) printf("%s%d", col ? ", " : "", bottom[col]);
+    printf("},\n         .minCol = %d, .maxCol = %d, .minRow = %d, .maxRow = %d},\n", minCol, maxCol, minRow, maxRow);
+}
+
+// Prints the initializer of one piece_t of set
+static void printPiece(const set_def_t* set, int p) {
+    const piece_def_t* def = &set->defs[p];
+    printf("{'%c', 0x%06X, {0x%07X, 0x%07X, 0x%07X, 0x%07X}, %d, %d, %s_geometry[%d]}", def->name, def->color,
+           def->rotations[0], def->rotations[1], def->rotations[2], def->rotations[3], p, set->square[p], set->name, p);
+}
+
+// Prints geometry tables, pieces and the piece_set_t of set. The tetromino set also keeps the names the rest of
+// the code uses for its pieces (i, j, l, o, s, t, z and pieces[7]).
+static void printSet(const set_def_t* set, int isTetromino) {
+    printf("static const piece_geometry_t %s_geometry[%d][4] = {\n", set->name, set->npieces);
+    for (int p = 0; p < set->npieces; p++) {
+        printf("    { // '%c'\n", set->defs[p].name);
+        for (int r = 0; r < 4; r++) printGeometry(set->defs[p].rotations[r]);
+        printf("    },\n");
+    }
+    printf("};\n\n");
+
+    if (isTetromino) {
+        for (int p = 0; p < set->npieces; p++) {
+            printf("const piece_t %c = ", set->defs[p].name);
+            printPiece(set, p);
+            printf(";\n");
+        }
+        printf("\nconst piece_t pieces[%d] = {", set->npieces);
+        for (int p = 0; p < set->npieces; p++) printf("%s%c", p ? ", " : "", set->defs[p].name);
+        printf("};\n\n");
+    } else {
+        printf("static const piece_t %s_pieces[%d] = {\n", set->name, set->npieces);
+        for (int p = 0; p < set->npieces; p++) {
+            printf("    ");
+            printPiece(set, p);
+            printf(",\n");
+        }
+        printf("};\n\n");
+    }
+
+    char piecesName[64];
+    if (isTetromino) snprintf(piecesName, sizeof(piecesName), "pieces");
+    else snprintf(piecesName, sizeof(piecesName), "%s_pieces", set->name);
+    printf("const piece_set_t %s_set = {\"%s\", %d, %s, {0", set->name, set->name, set->npieces, piecesName);
+    for (int square = 1; square < 16; square++) printf(", 0x%06X", set->palette[square]);
+    printf("}};\n\n");
+}
+
+int main(void) {
+    static set_def_t tetrominoes, pentominoes;
+    defineTetrominoes(&tetrominoes);
+    definePentominoes(&pentominoes);
+
+    printf("/* piece_sets.c\n");
+    printf("* -----------------------------------\n");
+    printf("* GENERATED by host/gen_piece_sets.c (make piece_sets.c) -- edit the generator, not this file.\n");
+    printf("*\n");
+    printf("* Piece sets with the geometry of every piece in every rotation precomputed at build time.\n");
+    printf("*/\n\n");
+    printf("#include \"game_engine.h\"\n\n");
+    printSet(&tetrominoes, 1);
+    printSet(&pentominoes, 0);
+    return 0;
+}
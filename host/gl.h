@@ -0,0 +1,7 @@
+#ifndef _HOST_GL_H
+#define _HOST_GL_H
+
+// Host stand-in for libmango gl.h: the engine only needs the color type
+typedef unsigned int color_t;
+
+#endif
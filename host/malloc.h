@@ -0,0 +1,7 @@
+#ifndef _HOST_MALLOC_H
+#define _HOST_MALLOC_H
+
+// Host stand-in for libmango malloc.h
+#include <stdlib.h>
+
+#endif
@@ -0,0 +1,185 @@
+/* replay.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* Host (Linux) replay corpus runner: re-simulates a corpus of replays (see replay.h) as fast as it can, checks that
+* every one reaches the final state it was recorded with, and reports replays and pieces re-simulated per second.
+* The corpus is every "replay: <hex>" line of the given logs (the device prints one at the end of each game), or,
+* without logs, games recorded here: the greedy autoplayer picks each placement and walks the piece there with the
+* inputs a player would use (swap, rotations, shifts, drops), so replays look like the device's.
+* Build with `make replay`, then run ./replay [-g games] [-r rounds] [-w corpus file] [log files...]
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "game_engine.h"
+#include "autoplayer.h"
+#include "replay.h"
+#include "timer.h"
+
+#define MAX_PIECES 300          // pieces per recorded game
+
+static replay_t* corpus;
+static int ncorpus;
+static int capacity;
+
+static replay_t* newReplay(void) {
+    if (ncorpus == capacity) {
+        capacity = capacity ? 2 * capacity : 64;
+        corpus = realloc(corpus, capacity * sizeof(replay_t));
+    }
+    return &corpus[ncorpus++];
+}
+
+// Records one game: each piece is walked to the autoplayer's choice of placement, ticks advancing as a player's
+// inputs would (a placement the piece can't walk to, a tuck say, is recorded as a REPLAY_PLACE)
+static void recordGame(autoplayer_t* player, unsigned int seed, replay_t* replay) {
+    game_state_t game;
+    game_engine_init(&game, 20, 10, seed);
+    game_engine_spawn(&game);
+    replay_init(replay, &game, seed);
+    falling_piece_t* piece = &game.piece;
+    unsigned long tick = 0;
+    autoplay_move_t move;
+    while (replay->pieces < MAX_PIECES && autoplayer_choose(player, &game, &move)) {
+        const placement_t* target = &move.placement;
+        tick += 40;
+        if (move.swap && game_engine_swap(&game, piece)) replay_record(replay, REPLAY_SWAP, tick++);
+        for (int n = 0; n < 4 && piece->rotation != target->rotation && game_engine_rotate(&game, piece); n++) {
+            replay_record(replay, REPLAY_ROTATE, tick += 4);
+        }
+        int dx = (target->x < piece->x) ? -1 : 1;
+        while (piece->x != target->x && game_engine_move(&game, piece, dx, 0)) {
+            replay_record(replay, dx < 0 ? REPLAY_LEFT : REPLAY_RIGHT, tick += 3);
+        }
+        while (piece->y < target->y && game_engine_move(&game, piece, 0, 1)) {
+            replay_record(replay, REPLAY_DOWN, tick++);
+        }
+        if (piece->x != target->x || piece->y != target->y || piece->rotation != target->rotation) {
+            piece->x = target->x;
+            piece->y = target->y;
+            piece->rotation = target->rotation;
+            replay_record_place(replay, target->x, target->y, target->rotation, tick);
+        }
+        replay_record(replay, REPLAY_LOCK, tick += 20);
+        game_engine_lock(&game, piece);
+        if (!game_engine_spawn(&game)) break;
+    }
+    replay_finish(replay, &game);
+    game_engine_free(&game);
+}
+
+static int hexDigit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Adds the replays of every "replay: <hex>" line of file to the corpus; returns how many it added
+static int loadLog(const char* path) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) {
+        perror(path);
+        return 0;
+    }
+    static char line[2 * (REPLAY_HEADER_BYTES + REPLAY_MAX_BYTES) + 64];
+    static unsigned char bytes[REPLAY_HEADER_BYTES + REPLAY_MAX_BYTES];
+    int added = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        const char* hex = strstr(line, "replay: ");
+        if (hex == NULL) continue;
+        hex += strlen("replay: ");
+        int length = 0;
+        while (length < (int)sizeof(bytes) && hexDigit(hex[2 * length]) >= 0 && hexDigit(hex[2 * length + 1]) >= 0) {
+            bytes[length] = hexDigit(hex[2 * length]) * 16 + hexDigit(hex[2 * length + 1]);
+            length++;
+        }
+        replay_t* replay = newReplay();
+        if (replay_deserialize(replay, bytes, length)) added++;
+        else ncorpus--;     // the summary line, or a garbled one
+    }
+    fclose(file);
+    return added;
+}
+
+static void writeCorpus(const char* path) {
+    FILE* file = fopen(path, "w");
+    static unsigned char bytes[REPLAY_HEADER_BYTES + REPLAY_MAX_BYTES];
+    for (int r = 0; r < ncorpus; r++) {
+        int length = replay_serialize(&corpus[r], bytes, sizeof(bytes));
+        fprintf(file, "replay: ");
+        for (int i = 0; i < length; i++) fprintf(file, "%02x", bytes[i]);
+        fprintf(file, "\n");
+    }
+    fclose(file);
+}
+
+int main(int argc, char* argv[]) {
+    int ngames = 200;
+    int rounds = 20;
+    const char* output = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "g:r:w:")) != -1) {
+        if (opt == 'g') ngames = atoi(optarg);
+        else if (opt == 'r') rounds = atoi(optarg);
+        else if (opt == 'w') output = optarg;
+        else {
+            fprintf(stderr, "usage: %s [-g games] [-r rounds] [-w corpus file] [log files...]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (optind < argc) {
+        for (int arg = optind; arg < argc; arg++) printf("%s: %d replays\n", argv[arg], loadLog(argv[arg]));
+    } else {
+        static autoplayer_t player;
+        autoplayer_init(&player, 20, 10, &autoplay_default_weights, 1, 1);
+        unsigned long start = timer_get_ticks();
+        for (int g = 0; g < ngames; g++) recordGame(&player, 107 + g, newReplay());
+        printf("recorded %d games in %.1f ms\n", ngames, (timer_get_ticks() - start) / 1e3);
+        autoplayer_free(&player);
+    }
+    if (ncorpus == 0) {
+        fprintf(stderr, "no replays\n");
+        return 1;
+    }
+    if (output != NULL) writeCorpus(output);
+
+    long pieces = 0, bytes = 0;
+    int incomplete = 0;
+    for (int r = 0; r < ncorpus; r++) {
+        pieces += corpus[r].pieces;
+        bytes += REPLAY_HEADER_BYTES + corpus[r].length;
+        if (!corpus[r].complete) incomplete++;
+    }
+    printf("corpus: %d replays, %ld pieces, %ld bytes (%.1f bytes/piece, header included), %d incomplete\n", ncorpus,
+           pieces, bytes, (double)bytes / (pieces ? pieces : 1), incomplete);
+
+    // every round re-simulates the whole corpus; the first one also checks each final state
+    int mismatches = 0;
+    unsigned long start = timer_get_ticks();
+    for (int round = 0; round < rounds; round++) {
+        for (int r = 0; r < ncorpus; r++) {
+            const replay_t* replay = &corpus[r];
+            game_state_t game;
+            int played = replay_play(replay, &game);
+            if (round == 0 && replay->complete && (played != replay->pieces || game.score != replay->score
+                    || game.linesCleared != replay->lines || replay_hash(&game) != replay->hash)) {
+                printf("replay %d (seed %u): %d pieces, score %d, lines %d; recorded %d pieces, score %d, lines %d\n",
+                       r, replay->seed, played, game.score, game.linesCleared, replay->pieces, replay->score, replay->lines);
+                mismatches++;
+            }
+            game_engine_free(&game);
+        }
+    }
+    unsigned long usecs = timer_get_ticks() - start;
+    if (usecs == 0) usecs = 1;
+    printf("%d rounds in %.1f ms: %.0f replays/sec, %.0f pieces/sec, %.1f MB/sec of replay; %d replays differ\n", rounds,
+           usecs / 1e3, (double)rounds * ncorpus * 1e6 / usecs, (double)rounds * pieces * 1e6 / usecs,
+           (double)rounds * bytes / usecs, mismatches);
+    free(corpus);
+    return mismatches ? 1 : 0;
+}
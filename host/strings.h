@@ -0,0 +1,7 @@
+#ifndef _HOST_STRINGS_H
+#define _HOST_STRINGS_H
+
+// Host stand-in for libmango strings.h (memset, memcpy, ...)
+#include <string.h>
+
+#endif
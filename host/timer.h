@@ -0,0 +1,15 @@
+#ifndef _HOST_TIMER_H
+#define _HOST_TIMER_H
+
+// Host stand-in for libmango timer.h: ticks come from the monotonic clock, one tick per microsecond
+#include <time.h>
+
+#define TICKS_PER_USEC 1
+
+static inline unsigned long timer_get_ticks(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000UL + now.tv_nsec / 1000;
+}
+
+#endif
@@ -0,0 +1,234 @@
+/* tune.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* Host (Linux) tuner of the autoplayer's board evaluation weights (see autoplay_weights_t), by the cross-entropy
+* method: each generation draws a population of weight vectors from a normal distribution, scores every vector by
+* the mean score of the greedy autoplayer over the same seeded games (the game's own rules: 28-piece bag, swap,
+* tucks), and refits the distribution to the best quarter. Games run in parallel on all cores.
+* Progress is checkpointed to tune.ckpt after every generation (a run picks up where the last one stopped), and
+* the distribution's mean is written to autoplay_weights.h, which the device build compiles in as the default
+* weights (autoplay_default_weights). The mean, rather than the generation's winner, since a winner on a handful
+* of games is mostly luck.
+* Build with `make tune`, then run ./tune [generations] [population] [games per vector] [max pieces per game] [threads]
+*/
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "game_engine.h"
+#include "autoplayer.h"
+#include "timer.h"
+
+#ifdef STATIC_BOARD
+#error "the tuner's games run in parallel, so boards have to come from the heap (build without STATIC_BOARD)"
+#endif
+
+#define NWEIGHTS 5
+#define MAX_POPULATION 256
+#define CHECKPOINT_FILE "tune.ckpt"
+#define HEADER_FILE "autoplay_weights.h"
+
+static const char* const weight_names[NWEIGHTS] = {"score", "holes", "height", "bumpiness", "wells"};
+
+// Distribution being tuned (what a checkpoint holds)
+static struct {
+    int generation;
+    double mean[NWEIGHTS];
+    double stddev[NWEIGHTS];
+    double fitness;             // mean score of the last generation's elite
+} tuner;
+
+// One generation's work for the threads: every (vector, game) pair is a job
+static struct {
+    int population;
+    int games;
+    int maxPieces;
+    unsigned int seedBase;
+    autoplay_weights_t weights[MAX_POPULATION];
+    long* scores;               // scores[vector * games + game]
+    int nextJob;                // taken with an atomic add
+} work;
+
+static autoplay_weights_t toWeights(const double* v) {
+    autoplay_weights_t weights = {
+        .score = (int)lround(v[0]), .holes = (int)lround(v[1]), .height = (int)lround(v[2]),
+        .bumpiness = (int)lround(v[3]), .wells = (int)lround(v[4]),
+    };
+    return weights;
+}
+
+static void* worker(void* arg) {
+    static const autoplay_weights_t none;
+    autoplayer_t* player = malloc(sizeof(autoplayer_t));
+    autoplayer_init(player, 20, 10, &none, 1, 1);
+    while (1) {
+        int job = __atomic_fetch_add(&work.nextJob, 1, __ATOMIC_RELAXED);
+        if (job >= work.population * work.games) break;
+        player->weights = work.weights[job / work.games];
+
+        // every vector plays the same games this generation (its seeds), so vectors differ only by their weights
+        game_state_t game;
+        game_engine_init(&game, 20, 10, work.seedBase + job % work.games);
+        game_engine_spawn(&game);
+        for (int pieces = 0; !game.gameOver && pieces < work.maxPieces; pieces++) autoplayer_play(player, &game);
+        work.scores[job] = game.score;
+        game_engine_free(&game);
+    }
+    autoplayer_free(player);
+    free(player);
+    return NULL;
+}
+
+// Plays every vector's games on nthreads threads
+static void runGeneration(int nthreads) {
+    work.nextJob = 0;
+    pthread_t threads[nthreads];
+    for (int t = 0; t < nthreads; t++) pthread_create(&threads[t], NULL, worker, NULL);
+    for (int t = 0; t < nthreads; t++) pthread_join(threads[t], NULL);
+}
+
+// Standard normal sample (Box-Muller) from a xorshift32 state
+static double gaussian(unsigned int* state) {
+    double u[2];
+    for (int n = 0; n < 2; n++) {
+        *state ^= *state << 13;
+        *state ^= *state >> 17;
+        *state ^= *state << 5;
+        u[n] = (*state + 1.0) / 4294967297.0;
+    }
+    return sqrt(-2 * log(u[0])) * cos(2 * M_PI * u[1]);
+}
+
+static bool loadCheckpoint(void) {
+    FILE* file = fopen(CHECKPOINT_FILE, "r");
+    if (file == NULL) return false;
+    bool ok = fscanf(file, "generation %d\n", &tuner.generation) == 1;
+    for (int w = 0; w < NWEIGHTS && ok; w++) {
+        ok = fscanf(file, "%*s %lf %lf\n", &tuner.mean[w], &tuner.stddev[w]) == 2;
+    }
+    ok = ok && fscanf(file, "fitness %lf\n", &tuner.fitness) == 1;
+    fclose(file);
+    return ok;
+}
+
+// Written to a temporary file first, so an interrupted run never leaves a half-written checkpoint
+static void saveCheckpoint(void) {
+    FILE* file = fopen(CHECKPOINT_FILE ".tmp", "w");
+    fprintf(file, "generation %d\n", tuner.generation);
+    for (int w = 0; w < NWEIGHTS; w++) {
+        fprintf(file, "%s %.6f %.6f\n", weight_names[w], tuner.mean[w], tuner.stddev[w]);
+    }
+    fprintf(file, "fitness %.3f\n", tuner.fitness);
+    fclose(file);
+    rename(CHECKPOINT_FILE ".tmp", CHECKPOINT_FILE);
+}
+
+static void writeHeader(int games, int maxPieces) {
+    autoplay_weights_t weights = toWeights(tuner.mean);
+    FILE* file = fopen(HEADER_FILE, "w");
+    fprintf(file, "/* autoplay_weights.h\n");
+    fprintf(file, "* -----------------------------------\n");
+    fprintf(file, "* GENERATED by host/tune.c (make tune; ./tune) -- rerun the tuner, don't edit by hand.\n");
+    fprintf(file, "*\n");
+    fprintf(file, "* Autoplayer evaluation weights after %d generations of cross-entropy tuning (elite mean score %.0f\n",
+            tuner.generation, tuner.fitness);
+    fprintf(file, "* over %d seeded games of up to %d pieces with the greedy autoplayer).\n", games, maxPieces);
+    fprintf(file, "*/\n\n");
+    fprintf(file, "#ifndef _AUTOPLAY_WEIGHTS_H\n#define _AUTOPLAY_WEIGHTS_H\n\n");
+    fprintf(file, "#define AUTOPLAY_TUNED_WEIGHTS { \\\n");
+    fprintf(file, "    .score = %d, \\\n    .holes = %d, \\\n    .height = %d, \\\n    .bumpiness = %d, \\\n    .wells = %d, \\\n}\n",
+            weights.score, weights.holes, weights.height, weights.bumpiness, weights.wells);
+    fprintf(file, "\n#endif\n");
+    fclose(file);
+}
+
+int main(int argc, char* argv[]) {
+    int generations = (argc > 1) ? atoi(argv[1]) : 20;
+    work.population = (argc > 2) ? atoi(argv[2]) : 32;
+    work.games = (argc > 3) ? atoi(argv[3]) : 16;
+    work.maxPieces = (argc > 4) ? atoi(argv[4]) : 500;
+    int nthreads = (argc > 5) ? atoi(argv[5]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (work.population < 4 || work.population > MAX_POPULATION || work.games < 1 || nthreads < 1) {
+        fprintf(stderr, "usage: %s [generations] [population 4-%d] [games per vector] [max pieces] [threads]\n",
+                argv[0], MAX_POPULATION);
+        return 2;
+    }
+    int elite = work.population / 4;
+    work.scores = malloc(work.population * work.games * sizeof(long));
+
+    if (loadCheckpoint()) {
+        printf("resuming from %s at generation %d (elite mean score %.0f)\n", CHECKPOINT_FILE, tuner.generation, tuner.fitness);
+    } else {
+        // start around the current default weights, with a spread of about their size
+        const autoplay_weights_t* start = &autoplay_default_weights;
+        double initial[NWEIGHTS] = {start->score, start->holes, start->height, start->bumpiness, start->wells};
+        for (int w = 0; w < NWEIGHTS; w++) {
+            tuner.mean[w] = initial[w];
+            tuner.stddev[w] = fabs(initial[w]) + 5;
+        }
+        tuner.generation = 0;
+        tuner.fitness = 0;
+    }
+
+    unsigned int rng = 107 + tuner.generation;
+    long gamesPlayed = 0;
+    unsigned long start = timer_get_ticks();
+    for (int g = 0; g < generations; g++) {
+        unsigned long genStart = timer_get_ticks();
+        static double vectors[MAX_POPULATION][NWEIGHTS];
+        for (int v = 0; v < work.population; v++) {
+            for (int w = 0; w < NWEIGHTS; w++) vectors[v][w] = tuner.mean[w] + tuner.stddev[w] * gaussian(&rng);
+            if (v == 0) for (int w = 0; w < NWEIGHTS; w++) vectors[v][w] = tuner.mean[w];  // the mean itself
+            work.weights[v] = toWeights(vectors[v]);
+        }
+        work.seedBase = 1000 * (tuner.generation + 1);
+        runGeneration(nthreads);
+        gamesPlayed += work.population * work.games;
+
+        // rank vectors by mean score (selection sort of the elite is plenty for these sizes)
+        double fitness[MAX_POPULATION];
+        int order[MAX_POPULATION];
+        for (int v = 0; v < work.population; v++) {
+            long total = 0;
+            for (int game = 0; game < work.games; game++) total += work.scores[v * work.games + game];
+            fitness[v] = (double)total / work.games;
+            order[v] = v;
+        }
+        for (int i = 0; i < elite; i++) {
+            for (int j = i + 1; j < work.population; j++) {
+                if (fitness[order[j]] > fitness[order[i]]) {
+                    int swap = order[i]; order[i] = order[j]; order[j] = swap;
+                }
+            }
+        }
+
+        // refit to the elite; a little extra spread keeps the search from collapsing too early
+        for (int w = 0; w < NWEIGHTS; w++) {
+            double mean = 0, var = 0;
+            for (int i = 0; i < elite; i++) mean += vectors[order[i]][w] / elite;
+            for (int i = 0; i < elite; i++) var += (vectors[order[i]][w] - mean) * (vectors[order[i]][w] - mean) / elite;
+            tuner.mean[w] = mean;
+            tuner.stddev[w] = sqrt(var) + 1.0 / (tuner.generation + 1);
+        }
+        double eliteFitness = 0;
+        for (int i = 0; i < elite; i++) eliteFitness += fitness[order[i]] / elite;
+        tuner.fitness = eliteFitness;
+        tuner.generation++;
+        saveCheckpoint();
+        writeHeader(work.games, work.maxPieces);
+
+        unsigned long genUsecs = timer_get_ticks() - genStart;
+        autoplay_weights_t mean = toWeights(tuner.mean);
+        printf("generation %3d: best %7.0f, elite %7.0f, old mean %7.0f | score %d holes %d height %d bumpiness %d wells %d | %.0f games/sec\n",
+               tuner.generation, fitness[order[0]], eliteFitness, fitness[0], mean.score, mean.holes, mean.height,
+               mean.bumpiness, mean.wells, work.population * work.games * 1e6 / (genUsecs ? genUsecs : 1));
+    }
+    unsigned long usecs = timer_get_ticks() - start;
+    printf("%d generations, %ld games on %d threads in %.1f s (%.0f games/sec); weights in %s\n", generations,
+           gamesPlayed, nthreads, usecs / 1e6, gamesPlayed * 1e6 / (usecs ? usecs : 1), HEADER_FILE);
+    free(work.scores);
+    return 0;
+}
@@ -16,8 +16,35 @@ void main(void) {
     // integration_test_v3() ;
     // integration_test_v8(); 
     // integration_test_v6() ; 
+    // test_bitboard_collision() ;
+    // test_bitboard_benchmark() ;
+    // test_clear_rows() ;
+    // test_board_ring() ;
+    // test_board_clear_benchmark() ;
+    // test_landing_row() ;
+    // test_game_engine() ;
+    // test_snapshots() ;
+    // test_board_cells_benchmark() ;
+    // test_move_cost() ;
+    // test_piece_sets() ;
+    // test_piece_queue() ;
+    // test_game_input() ;
+    // test_game_scheduler() ;
+    // test_fixed_point() ;
+    // test_timer_wheel() ;
+    // test_game_events() ;
+    // test_frame_coalescing() ;
+    // test_placements() ;
+    // test_placement_benchmark() ;
+    // test_autoplayer() ;
+    // test_anytime_search() ;
+    // test_replay() ;
+    // test_remote_script() ;
 
     // Final game loop used in demo!
     integration_test_v10(); 
+    // integration_test_v11(false) ; // hint outline (true -> autopilot)
+    // integration_test_v12(NULL, 1) ; // benchmark run on a script sent over UART
+    // integration_test_v12(benchmark_script, 20) ; // ... or on the built-in one
 
 }
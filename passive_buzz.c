@@ -12,6 +12,7 @@
 #include "interrupts.h"
 #include "hstimer.h"
 #include "music.h"
+#include "fixed_point.h"
 
 #define TICKS_PER_USEC 24 // 24 ticks counted per one microsecond
 #define uSEC_IN_SEC 1000000
@@ -54,12 +55,12 @@ void buzzer_play_note(int frequency, int duration_msec) {
 
     duration_msec = duration_msec * 60 / tempo ; // updates speed of song based on tempo
 
-    unsigned long busy_wait_until = (timer_get_ticks() + (duration_msec*1000*TICKS_PER_USEC))  ; // turn into milliseconds
+    unsigned long busy_wait_until = timer_get_ticks() + MSEC_TO_TICKS(duration_msec) ;
     int note_frequency = frequency ; 
     int note_period = (uSEC_IN_SEC / note_frequency) ; // keep it approximate
 
     while (timer_get_ticks() < busy_wait_until) {
-        double total_duration = 0 ;
+        unsigned int total_duration = 0 ; // usec of tone played (integer: no soft-float in the tone loop)
         while(total_duration <= (uSEC_IN_SEC/4)) {
             total_duration += note_period; 
             gpio_write(buzzer_id, 1);
@@ -9,6 +9,7 @@
 #include "interrupts.h"
 #include "hstimer.h"
 #include "music.h"
+#include "timer_wheel.h"
 #include <stddef.h>
 
 #define uSEC_IN_SEC 1000000
@@ -74,6 +75,7 @@ const int tetris_song[93][2] = // note freq followed by duration. each 2 lines a
                     } ;
 
 static int song_index ;
+static sw_timer_t note_timer ; // note changes run on a timer_wheel timer (the wheel's tick uses HSTIMER1)
 
 // `freq_to_period_us`
 // @param frequency in Hertz (1/s)
@@ -96,12 +98,10 @@ static void handle_note_buzz(uintptr_t pc, void *aux_data) {
 }
 
 // `handle_note_change`
-// handler for INTERRUPT_SOURCE_HSTIMER1
-// uses HSTIMER1's countdown to indicate when the note should change to the next 
+// note_timer callback (runs from the timer wheel's tick interrupt)
+// fires when the note should change to the next 
 //      note, and updates HSTIMER0's frequency to the appropriate note
-static void handle_note_change(uintptr_t pc, void *aux_data) {
-    hstimer_interrupt_clear(HSTIMER1);
-
+static void handle_note_change(void *aux_data) {
     // iterates to next note in the song 
     song_index = (song_index+1) % song_length; // 8*4*6 is the number of notes in the tetris song
 
@@ -111,8 +111,7 @@ static void handle_note_change(uintptr_t pc, void *aux_data) {
     hstimer_init(HSTIMER0, (freq_to_period_us(tetris_song[song_index][0]) / 2)) ; 
     hstimer_enable(HSTIMER0) ;
 
-    hstimer_init(HSTIMER1, tempo * tetris_song[song_index][1]) ; // for the proper note length
-    hstimer_enable(HSTIMER1) ;
+    timer_wheel_start(&note_timer, tempo * tetris_song[song_index][1], 0, handle_note_change, NULL) ; // for the proper note length
 }
 
 // `buzzer_intr_init`
@@ -135,12 +134,9 @@ void buzzer_intr_init(gpio_id_t id, int tempo_) {
     hstimer_init(HSTIMER0, freq_to_period_us(tetris_song[song_index][0]) / 2) ; 
     hstimer_enable(HSTIMER0) ;
 
-    // INTERRUPT_SOURCE_HSTIMER1 to change which note is playing
-    interrupts_enable_source(INTERRUPT_SOURCE_HSTIMER1); 
-    interrupts_register_handler(INTERRUPT_SOURCE_HSTIMER1, handle_note_change, NULL) ;
-    // hstimer_init(HSTIMER1, 300000) ; 
-    hstimer_init(HSTIMER1, tetris_song[song_index][1]) ; 
-    hstimer_enable(HSTIMER1) ;
+    // a timer wheel timer to change which note is playing (HSTIMER1 drives the wheel, shared with other modules)
+    timer_wheel_init() ;
+    timer_wheel_start(&note_timer, tetris_song[song_index][1], 0, handle_note_change, NULL) ;
 
     is_playing = true ;
 }
@@ -168,7 +164,7 @@ void buzzer_intr_restart_song(void) {
 // 'buzzer_intr_pause'
 // pause music
 void buzzer_intr_pause(void) {
-    hstimer_disable(HSTIMER1) ;
+    timer_wheel_cancel(&note_timer) ;
     hstimer_disable(HSTIMER0) ;
     is_playing = false ;
 }
@@ -177,7 +173,7 @@ void buzzer_intr_pause(void) {
 // resume music
 void buzzer_intr_play(void) {
     hstimer_enable(HSTIMER0) ;
-    hstimer_enable(HSTIMER1) ;
+    timer_wheel_start(&note_timer, tempo * tetris_song[song_index][1], 0, handle_note_change, NULL) ;
     is_playing = true ;
 }
 
@@ -0,0 +1,310 @@
+/* piece_sets.c
+* -----------------------------------
+* GENERATED by host/gen_piece_sets.c (make piece_sets.c) -- edit the generator, not this file.
+*
+* Piece sets with the geometry of every piece in every rotation precomputed at build time.
+*/
+
+#include "game_engine.h"
+
+static const piece_geometry_t tetromino_geometry[7][4] = {
+    { // 'i'
+        {.cells = {{0, 1}, {1, 1}, {2, 1}, {3, 1}}, .ncells = 4,
+         .rowBits = {0x00, 0x0F, 0x00, 0x00, 0x00}, .bottom = {1, 1, 1, 1, -1},
+         .minCol = 0, .maxCol = 3, .minRow = 1, .maxRow = 1},
+        {.cells = {{2, 0}, {2, 1}, {2, 2}, {2, 3}}, .ncells = 4,
+         .rowBits = {0x04, 0x04, 0x04, 0x04, 0x00}, .bottom = {-1, -1, 3, -1, -1},
+         .minCol = 2, .maxCol = 2, .minRow = 0, .maxRow = 3},
+        {.cells = {{0, 2}, {1, 2}, {2, 2}, {3, 2}}, .ncells = 4,
+         .rowBits = {0x00, 0x00, 0x0F, 0x00, 0x00}, .bottom = {2, 2, 2, 2, -1},
+         .minCol = 0, .maxCol = 3, .minRow = 2, .maxRow = 2},
+        {.cells = {{1, 0}, {1, 1}, {1, 2}, {1, 3}}, .ncells = 4,
+         .rowBits = {0x02, 0x02, 0x02, 0x02, 0x00}, .bottom = {-1, 3, -1, -1, -1},
+         .minCol = 1, .maxCol = 1, .minRow = 0, .maxRow = 3},
+    },
+    { // 'j'
+        {.cells = {{1, 0}, {1, 1}, {0, 2}, {1, 2}}, .ncells = 4,
+         .rowBits = {0x02, 0x02, 0x03, 0x00, 0x00}, .bottom = {2, 2, -1, -1, -1},
+         .minCol = 0, .maxCol = 1, .minRow = 0, .maxRow = 2},
+        {.cells = {{0, 0}, {0, 1}, {1, 1}, {2, 1}}, .ncells = 4,
+         .rowBits = {0x01, 0x07, 0x00, 0x00, 0x00}, .bottom = {1, 1, 1, -1, -1},
+         .minCol = 0, .maxCol = 2, .minRow = 0, .maxRow = 1},
+        {.cells = {{1, 0}, {2, 0}, {1, 1}, {1, 2}}, .ncells = 4,
+         .rowBits = {0x06, 0x02, 0x02, 0x00, 0x00}, .bottom = {-1, 2, 0, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 0, .maxRow = 2},
+        {.cells = {{0, 1}, {1, 1}, {2, 1}, {2, 2}}, .ncells = 4,
+         .rowBits = {0x00, 0x07, 0x04, 0x00, 0x00}, .bottom = {1, 1, 2, -1, -1},
+         .minCol = 0, .maxCol = 2, .minRow = 1, .maxRow = 2},
+    },
+    { // 'l'
+        {.cells = {{1, 0}, {1, 1}, {1, 2}, {2, 2}}, .ncells = 4,
+         .rowBits = {0x02, 0x02, 0x06, 0x00, 0x00}, .bottom = {-1, 2, 2, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 0, .maxRow = 2},
+        {.cells = {{0, 1}, {1, 1}, {2, 1}, {0, 2}}, .ncells = 4,
+         .rowBits = {0x00, 0x07, 0x01, 0x00, 0x00}, .bottom = {2, 1, 1, -1, -1},
+         .minCol = 0, .maxCol = 2, .minRow = 1, .maxRow = 2},
+        {.cells = {{0, 0}, {1, 0}, {1, 1}, {1, 2}}, .ncells = 4,
+         .rowBits = {0x03, 0x02, 0x02, 0x00, 0x00}, .bottom = {0, 2, -1, -1, -1},
+         .minCol = 0, .maxCol = 1, .minRow = 0, .maxRow = 2},
+        {.cells = {{2, 0}, {0, 1}, {1, 1}, {2, 1}}, .ncells = 4,
+         .rowBits = {0x04, 0x07, 0x00, 0x00, 0x00}, .bottom = {1, 1, 1, -1, -1},
+         .minCol = 0, .maxCol = 2, .minRow = 0, .maxRow = 1},
+    },
+    { // 'o'
+        {.cells = {{1, 0}, {2, 0}, {1, 1}, {2, 1}}, .ncells = 4,
+         .rowBits = {0x06, 0x06, 0x00, 0x00, 0x00}, .bottom = {-1, 1, 1, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 0, .maxRow = 1},
+        {.cells = {{1, 0}, {2, 0}, {1, 1}, {2, 1}}, .ncells = 4,
+         .rowBits = {0x06, 0x06, 0x00, 0x00, 0x00}, .bottom = {-1, 1, 1, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 0, .maxRow = 1},
+        {.cells = {{1, 0}, {2, 0}, {1, 1}, {2, 1}}, .ncells = 4,
+         .rowBits = {0x06, 0x06, 0x00, 0x00, 0x00}, .bottom = {-1, 1, 1, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 0, .maxRow = 1},
+        {.cells = {{1, 0}, {2, 0}, {1, 1}, {2, 1}}, .ncells = 4,
+         .rowBits = {0x06, 0x06, 0x00, 0x00, 0x00}, .bottom = {-1, 1, 1, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 0, .maxRow = 1},
+    },
+    { // 's'
+        {.cells = {{1, 1}, {2, 1}, {0, 2}, {1, 2}}, .ncells = 4,
+         .rowBits = {0x00, 0x06, 0x03, 0x00, 0x00}, .bottom = {2, 2, 1, -1, -1},
+         .minCol = 0, .maxCol = 2, .minRow = 1, .maxRow = 2},
+        {.cells = {{0, 0}, {0, 1}, {1, 1}, {1, 2}}, .ncells = 4,
+         .rowBits = {0x01, 0x03, 0x02, 0x00, 0x00}, .bottom = {1, 2, -1, -1, -1},
+         .minCol = 0, .maxCol = 1, .minRow = 0, .maxRow = 2},
+        {.cells = {{1, 0}, {2, 0}, {0, 1}, {1, 1}}, .ncells = 4,
+         .rowBits = {0x06, 0x03, 0x00, 0x00, 0x00}, .bottom = {1, 1, 0, -1, -1},
+         .minCol = 0, .maxCol = 2, .minRow = 0, .maxRow = 1},
+        {.cells = {{1, 0}, {1, 1}, {2, 1}, {2, 2}}, .ncells = 4,
+         .rowBits = {0x02, 0x06, 0x04, 0x00, 0x00}, .bottom = {-1, 1, 2, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 0, .maxRow = 2},
+    },
+    { // 't'
+        {.cells = {{0, 1}, {1, 1}, {2, 1}, {1, 2}}, .ncells = 4,
+         .rowBits = {0x00, 0x07, 0x02, 0x00, 0x00}, .bottom = {1, 2, 1, -1, -1},
+         .minCol = 0, .maxCol = 2, .minRow = 1, .maxRow = 2},
+        {.cells = {{1, 0}, {0, 1}, {1, 1}, {1, 2}}, .ncells = 4,
+         .rowBits = {0x02, 0x03, 0x02, 0x00, 0x00}, .bottom = {1, 2, -1, -1, -1},
+         .minCol = 0, .maxCol = 1, .minRow = 0, .maxRow = 2},
+        {.cells = {{1, 0}, {0, 1}, {1, 1}, {2, 1}}, .ncells = 4,
+         .rowBits = {0x02, 0x07, 0x00, 0x00, 0x00}, .bottom = {1, 1, 1, -1, -1},
+         .minCol = 0, .maxCol = 2, .minRow = 0, .maxRow = 1},
+        {.cells = {{1, 0}, {1, 1}, {2, 1}, {1, 2}}, .ncells = 4,
+         .rowBits = {0x02, 0x06, 0x02, 0x00, 0x00}, .bottom = {-1, 2, 1, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 0, .maxRow = 2},
+    },
+    { // 'z'
+        {.cells = {{0, 1}, {1, 1}, {1, 2}, {2, 2}}, .ncells = 4,
+         .rowBits = {0x00, 0x03, 0x06, 0x00, 0x00}, .bottom = {1, 2, 2, -1, -1},
+         .minCol = 0, .maxCol = 2, .minRow = 1, .maxRow = 2},
+        {.cells = {{1, 0}, {0, 1}, {1, 1}, {0, 2}}, .ncells = 4,
+         .rowBits = {0x02, 0x03, 0x01, 0x00, 0x00}, .bottom = {2, 1, -1, -1, -1},
+         .minCol = 0, .maxCol = 1, .minRow = 0, .maxRow = 2},
+        {.cells = {{0, 0}, {1, 0}, {1, 1}, {2, 1}}, .ncells = 4,
+         .rowBits = {0x03, 0x06, 0x00, 0x00, 0x00}, .bottom = {0, 1, 1, -1, -1},
+         .minCol = 0, .maxCol = 2, .minRow = 0, .maxRow = 1},
+        {.cells = {{2, 0}, {1, 1}, {2, 1}, {1, 2}}, .ncells = 4,
+         .rowBits = {0x04, 0x06, 0x02, 0x00, 0x00}, .bottom = {-1, 2, 1, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 0, .maxRow = 2},
+    },
+};
+
+const piece_t i = {'i', 0x1AE6DC, {0x00F0000, 0x0421080, 0x0007800, 0x0842100}, 0, 1, tetromino_geometry[0]};
+const piece_t j = {'j', 0x0000E4, {0x0846000, 0x10E0000, 0x0C42000, 0x00E1000}, 1, 2, tetromino_geometry[1]};
+const piece_t l = {'l', 0xEA9B11, {0x0843000, 0x00E4000, 0x1842000, 0x04E0000}, 2, 3, tetromino_geometry[2]};
+const piece_t o = {'o', 0xE5E900, {0x0C60000, 0x0C60000, 0x0C60000, 0x0C60000}, 3, 4, tetromino_geometry[3]};
+const piece_t s = {'s', 0x03E800, {0x0066000, 0x10C2000, 0x0CC0000, 0x0861000}, 4, 5, tetromino_geometry[4]};
+const piece_t t = {'t', 0x9305E2, {0x00E2000, 0x08C2000, 0x08E0000, 0x0862000}, 5, 6, tetromino_geometry[5]};
+const piece_t z = {'z', 0xE80201, {0x00C3000, 0x08C4000, 0x1860000, 0x0462000}, 6, 7, tetromino_geometry[6]};
+
+const piece_t pieces[7] = {i, j, l, o, s, t, z};
+
+const piece_set_t tetromino_set = {"tetromino", 7, pieces, {0, 0x1AE6DC, 0x0000E4, 0xEA9B11, 0xE5E900, 0x03E800, 0x9305E2, 0xE80201, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000}};
+
+static const piece_geometry_t pentomino_geometry[12][4] = {
+    { // 'f'
+        {.cells = {{2, 1}, {3, 1}, {1, 2}, {2, 2}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x0C, 0x06, 0x04, 0x00}, .bottom = {-1, 2, 3, 1, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{2, 1}, {1, 2}, {2, 2}, {3, 2}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x04, 0x0E, 0x08, 0x00}, .bottom = {-1, 2, 2, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{2, 1}, {2, 2}, {3, 2}, {1, 3}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x04, 0x0C, 0x06, 0x00}, .bottom = {-1, 3, 3, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{1, 1}, {1, 2}, {2, 2}, {3, 2}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x02, 0x0E, 0x04, 0x00}, .bottom = {-1, 2, 3, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+    },
+    { // 'i'
+        {.cells = {{2, 0}, {2, 1}, {2, 2}, {2, 3}, {2, 4}}, .ncells = 5,
+         .rowBits = {0x04, 0x04, 0x04, 0x04, 0x04}, .bottom = {-1, -1, 4, -1, -1},
+         .minCol = 2, .maxCol = 2, .minRow = 0, .maxRow = 4},
+        {.cells = {{0, 2}, {1, 2}, {2, 2}, {3, 2}, {4, 2}}, .ncells = 5,
+         .rowBits = {0x00, 0x00, 0x1F, 0x00, 0x00}, .bottom = {2, 2, 2, 2, 2},
+         .minCol = 0, .maxCol = 4, .minRow = 2, .maxRow = 2},
+        {.cells = {{2, 0}, {2, 1}, {2, 2}, {2, 3}, {2, 4}}, .ncells = 5,
+         .rowBits = {0x04, 0x04, 0x04, 0x04, 0x04}, .bottom = {-1, -1, 4, -1, -1},
+         .minCol = 2, .maxCol = 2, .minRow = 0, .maxRow = 4},
+        {.cells = {{0, 2}, {1, 2}, {2, 2}, {3, 2}, {4, 2}}, .ncells = 5,
+         .rowBits = {0x00, 0x00, 0x1F, 0x00, 0x00}, .bottom = {2, 2, 2, 2, 2},
+         .minCol = 0, .maxCol = 4, .minRow = 2, .maxRow = 2},
+    },
+    { // 'l'
+        {.cells = {{2, 0}, {2, 1}, {2, 2}, {2, 3}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x04, 0x04, 0x04, 0x0C, 0x00}, .bottom = {-1, -1, 3, 3, -1},
+         .minCol = 2, .maxCol = 3, .minRow = 0, .maxRow = 3},
+        {.cells = {{1, 2}, {2, 2}, {3, 2}, {4, 2}, {1, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x00, 0x1E, 0x02, 0x00}, .bottom = {-1, 3, 2, 2, 2},
+         .minCol = 1, .maxCol = 4, .minRow = 2, .maxRow = 3},
+        {.cells = {{1, 1}, {2, 1}, {2, 2}, {2, 3}, {2, 4}}, .ncells = 5,
+         .rowBits = {0x00, 0x06, 0x04, 0x04, 0x04}, .bottom = {-1, 1, 4, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 1, .maxRow = 4},
+        {.cells = {{3, 1}, {0, 2}, {1, 2}, {2, 2}, {3, 2}}, .ncells = 5,
+         .rowBits = {0x00, 0x08, 0x0F, 0x00, 0x00}, .bottom = {2, 2, 2, 2, -1},
+         .minCol = 0, .maxCol = 3, .minRow = 1, .maxRow = 2},
+    },
+    { // 'n'
+        {.cells = {{3, 0}, {3, 1}, {2, 2}, {3, 2}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x08, 0x08, 0x0C, 0x04, 0x00}, .bottom = {-1, -1, 3, 2, -1},
+         .minCol = 2, .maxCol = 3, .minRow = 0, .maxRow = 3},
+        {.cells = {{1, 2}, {2, 2}, {2, 3}, {3, 3}, {4, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x00, 0x06, 0x1C, 0x00}, .bottom = {-1, 2, 3, 3, 3},
+         .minCol = 1, .maxCol = 4, .minRow = 2, .maxRow = 3},
+        {.cells = {{2, 1}, {1, 2}, {2, 2}, {1, 3}, {1, 4}}, .ncells = 5,
+         .rowBits = {0x00, 0x04, 0x06, 0x02, 0x02}, .bottom = {-1, 4, 2, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 1, .maxRow = 4},
+        {.cells = {{0, 1}, {1, 1}, {2, 1}, {2, 2}, {3, 2}}, .ncells = 5,
+         .rowBits = {0x00, 0x07, 0x0C, 0x00, 0x00}, .bottom = {1, 1, 2, 2, -1},
+         .minCol = 0, .maxCol = 3, .minRow = 1, .maxRow = 2},
+    },
+    { // 'p'
+        {.cells = {{2, 1}, {3, 1}, {2, 2}, {3, 2}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x0C, 0x0C, 0x04, 0x00}, .bottom = {-1, -1, 3, 2, -1},
+         .minCol = 2, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{1, 2}, {2, 2}, {3, 2}, {2, 3}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x00, 0x0E, 0x0C, 0x00}, .bottom = {-1, 2, 3, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 2, .maxRow = 3},
+        {.cells = {{2, 1}, {1, 2}, {2, 2}, {1, 3}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x04, 0x06, 0x06, 0x00}, .bottom = {-1, 3, 3, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 1, .maxRow = 3},
+        {.cells = {{1, 1}, {2, 1}, {1, 2}, {2, 2}, {3, 2}}, .ncells = 5,
+         .rowBits = {0x00, 0x06, 0x0E, 0x00, 0x00}, .bottom = {-1, 2, 2, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 2},
+    },
+    { // 't'
+        {.cells = {{1, 1}, {2, 1}, {3, 1}, {2, 2}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x0E, 0x04, 0x04, 0x00}, .bottom = {-1, 1, 3, 1, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{3, 1}, {1, 2}, {2, 2}, {3, 2}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x08, 0x0E, 0x08, 0x00}, .bottom = {-1, 2, 2, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{2, 1}, {2, 2}, {1, 3}, {2, 3}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x04, 0x04, 0x0E, 0x00}, .bottom = {-1, 3, 3, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{1, 1}, {1, 2}, {2, 2}, {3, 2}, {1, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x02, 0x0E, 0x02, 0x00}, .bottom = {-1, 3, 2, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+    },
+    { // 'u'
+        {.cells = {{1, 1}, {3, 1}, {1, 2}, {2, 2}, {3, 2}}, .ncells = 5,
+         .rowBits = {0x00, 0x0A, 0x0E, 0x00, 0x00}, .bottom = {-1, 2, 2, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 2},
+        {.cells = {{2, 1}, {3, 1}, {2, 2}, {2, 3}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x0C, 0x04, 0x0C, 0x00}, .bottom = {-1, -1, 3, 3, -1},
+         .minCol = 2, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{1, 2}, {2, 2}, {3, 2}, {1, 3}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x00, 0x0E, 0x0A, 0x00}, .bottom = {-1, 3, 2, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 2, .maxRow = 3},
+        {.cells = {{1, 1}, {2, 1}, {2, 2}, {1, 3}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x06, 0x04, 0x06, 0x00}, .bottom = {-1, 3, 3, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 1, .maxRow = 3},
+    },
+    { // 'v'
+        {.cells = {{1, 1}, {1, 2}, {1, 3}, {2, 3}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x02, 0x02, 0x0E, 0x00}, .bottom = {-1, 3, 3, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{1, 1}, {2, 1}, {3, 1}, {1, 2}, {1, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x0E, 0x02, 0x02, 0x00}, .bottom = {-1, 3, 1, 1, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{1, 1}, {2, 1}, {3, 1}, {3, 2}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x0E, 0x08, 0x08, 0x00}, .bottom = {-1, 1, 1, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{3, 1}, {3, 2}, {1, 3}, {2, 3}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x08, 0x08, 0x0E, 0x00}, .bottom = {-1, 3, 3, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+    },
+    { // 'w'
+        {.cells = {{1, 1}, {1, 2}, {2, 2}, {2, 3}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x02, 0x06, 0x0C, 0x00}, .bottom = {-1, 2, 3, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{2, 1}, {3, 1}, {1, 2}, {2, 2}, {1, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x0C, 0x06, 0x02, 0x00}, .bottom = {-1, 3, 2, 1, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{1, 1}, {2, 1}, {2, 2}, {3, 2}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x06, 0x0C, 0x08, 0x00}, .bottom = {-1, 1, 2, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{3, 1}, {2, 2}, {3, 2}, {1, 3}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x08, 0x0C, 0x06, 0x00}, .bottom = {-1, 3, 3, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+    },
+    { // 'x'
+        {.cells = {{2, 1}, {1, 2}, {2, 2}, {3, 2}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x04, 0x0E, 0x04, 0x00}, .bottom = {-1, 2, 3, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{2, 1}, {1, 2}, {2, 2}, {3, 2}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x04, 0x0E, 0x04, 0x00}, .bottom = {-1, 2, 3, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{2, 1}, {1, 2}, {2, 2}, {3, 2}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x04, 0x0E, 0x04, 0x00}, .bottom = {-1, 2, 3, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{2, 1}, {1, 2}, {2, 2}, {3, 2}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x04, 0x0E, 0x04, 0x00}, .bottom = {-1, 2, 3, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+    },
+    { // 'y'
+        {.cells = {{2, 0}, {1, 1}, {2, 1}, {2, 2}, {2, 3}}, .ncells = 5,
+         .rowBits = {0x04, 0x06, 0x04, 0x04, 0x00}, .bottom = {-1, 1, 3, -1, -1},
+         .minCol = 1, .maxCol = 2, .minRow = 0, .maxRow = 3},
+        {.cells = {{3, 1}, {1, 2}, {2, 2}, {3, 2}, {4, 2}}, .ncells = 5,
+         .rowBits = {0x00, 0x08, 0x1E, 0x00, 0x00}, .bottom = {-1, 2, 2, 2, 2},
+         .minCol = 1, .maxCol = 4, .minRow = 1, .maxRow = 2},
+        {.cells = {{2, 1}, {2, 2}, {2, 3}, {3, 3}, {2, 4}}, .ncells = 5,
+         .rowBits = {0x00, 0x04, 0x04, 0x0C, 0x04}, .bottom = {-1, -1, 4, 3, -1},
+         .minCol = 2, .maxCol = 3, .minRow = 1, .maxRow = 4},
+        {.cells = {{0, 2}, {1, 2}, {2, 2}, {3, 2}, {1, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x00, 0x0F, 0x02, 0x00}, .bottom = {2, 3, 2, 2, -1},
+         .minCol = 0, .maxCol = 3, .minRow = 2, .maxRow = 3},
+    },
+    { // 'z'
+        {.cells = {{1, 1}, {2, 1}, {2, 2}, {2, 3}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x06, 0x04, 0x0C, 0x00}, .bottom = {-1, 1, 3, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{3, 1}, {1, 2}, {2, 2}, {3, 2}, {1, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x08, 0x0E, 0x02, 0x00}, .bottom = {-1, 3, 2, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{1, 1}, {2, 1}, {2, 2}, {2, 3}, {3, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x06, 0x04, 0x0C, 0x00}, .bottom = {-1, 1, 3, 3, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+        {.cells = {{3, 1}, {1, 2}, {2, 2}, {3, 2}, {1, 3}}, .ncells = 5,
+         .rowBits = {0x00, 0x08, 0x0E, 0x02, 0x00}, .bottom = {-1, 3, 2, 2, -1},
+         .minCol = 1, .maxCol = 3, .minRow = 1, .maxRow = 3},
+    },
+};
+
+static const piece_t pentomino_pieces[12] = {
+    {'f', 0x1AE6DC, {0x0033080, 0x0023840, 0x0021980, 0x0043880}, 0, 1, pentomino_geometry[0]},
+    {'i', 0xE80201, {0x0421084, 0x0007C00, 0x0421084, 0x0007C00}, 1, 2, pentomino_geometry[1]},
+    {'l', 0xEA9B11, {0x04210C0, 0x0003D00, 0x0061084, 0x0017800}, 2, 3, pentomino_geometry[2]},
+    {'n', 0x0000E4, {0x0211880, 0x00030E0, 0x0023108, 0x00E1800}, 3, 4, pentomino_geometry[3]},
+    {'p', 0xE5E900, {0x0031880, 0x00038C0, 0x0023180, 0x0063800}, 4, 5, pentomino_geometry[4]},
+    {'t', 0x9305E2, {0x0071080, 0x0013840, 0x00211C0, 0x0043900}, 5, 6, pentomino_geometry[5]},
+    {'u', 0x03E800, {0x0053800, 0x00310C0, 0x0003940, 0x0061180}, 6, 7, pentomino_geometry[6]},
+    {'v', 0xCB4899, {0x00421C0, 0x0072100, 0x0070840, 0x00109C0}, 7, 8, pentomino_geometry[7]},
+    {'w', 0xF9D740, {0x00430C0, 0x0033100, 0x0061840, 0x0011980}, 8, 9, pentomino_geometry[8]},
+    {'x', 0x219756, {0x0023880, 0x0023880, 0x0023880, 0x0023880}, 9, 10, pentomino_geometry[9]},
+    {'y', 0x7F7FFF, {0x0461080, 0x0013C00, 0x00210C4, 0x0007900}, 10, 11, pentomino_geometry[10]},
+    {'z', 0xFF7F00, {0x00610C0, 0x0013900, 0x00610C0, 0x0013900}, 11, 12, pentomino_geometry[11]},
+};
+
+const piece_set_t pentomino_set = {"pentomino", 12, pentomino_pieces, {0, 0x1AE6DC, 0xE80201, 0xEA9B11, 0x0000E4, 0xE5E900, 0x9305E2, 0x03E800, 0xCB4899, 0xF9D740, 0x219756, 0x7F7FFF, 0xFF7F00, 0x000000, 0x000000, 0x000000}};
+
@@ -0,0 +1,139 @@
+/* placement.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The placement.c module finds every position where a falling piece can lock (see placement.h), for hints on the
+* device and for analysis and autoplay on the host. It's a breadth-first search over piece states: each state is
+* a bit in a visited bitmap, so no state is tested twice, and the collision tests are the engine's own (bitboard
+* or grid), so the placements found are exactly the ones the game allows.
+*/
+
+#include "placement.h"
+#include "assert.h"
+#include "strings.h"
+#ifndef STATIC_BOARD
+#include "malloc.h"
+#endif
+
+#define BIT_TEST(bits, n) ((bits)[(n) >> 3] & (1 << ((n) & 7)))
+#define BIT_SET(bits, n) ((bits)[(n) >> 3] |= (1 << ((n) & 7)))
+
+// Required init: workspace for searches on nrows x ncols boards
+void placement_init(placement_search_t* search, int nrows, int ncols) {
+    search->nrows = nrows;
+    search->ncols = ncols;
+    search->width = ncols + PIECE_GRID - 1;
+    search->height = nrows + PIECE_GRID - 1;
+    search->nstates = PLACEMENT_STATES(nrows, ncols);
+    assert(search->nstates <= 0x7FFF);     // state numbers are queued as shorts
+#ifdef STATIC_BOARD
+    assert(nrows == NROWS && ncols == NCOLS);
+#else
+    int bytes = (search->nstates + 7) / 8;
+    search->visited = malloc(bytes);
+    search->locked = malloc(bytes);
+    search->queue = malloc(search->nstates * sizeof(short));
+#endif
+}
+
+void placement_free(placement_search_t* search) {
+#ifndef STATIC_BOARD
+    free(search->visited);
+    free(search->locked);
+    free(search->queue);
+#endif
+}
+
+// Returns whether two rotations cover the same squares when their top left squares line up
+static bool sameShape(const piece_geometry_t* a, const piece_geometry_t* b) {
+    if (a->ncells != b->ncells || a->maxRow - a->minRow != b->maxRow - b->minRow) return false;
+    for (int row = 0; row <= a->maxRow - a->minRow; row++) {
+        if ((a->rowBits[a->minRow + row] >> a->minCol) != (b->rowBits[b->minRow + row] >> b->minCol)) return false;
+    }
+    return true;
+}
+
+/* Fills out with the distinct positions (at most max) where piece can lock on state's board, reachable from where
+piece is now by moving left, right, down and rotating; returns how many were found (0 if piece doesn't fit where
+it is). Placements come out in the order the search reaches them, so the closest ones to the piece come first.
+*/
+int placement_enumerate(placement_search_t* search, const game_state_t* state, const falling_piece_t* piece,
+                        placement_t* out, int max) {
+    falling_piece_t probe = *piece;
+    if (!game_engine_is_valid_position(state, &probe)) return 0;
+
+    // lock positions are recorded under the first rotation with the same shape, so symmetric rotations count once
+    int canonical[4], dx[4], dy[4];
+    for (int rot = 0; rot < 4; rot++) {
+        const piece_geometry_t* geom = &piece->pieceT.geometry[rot];
+        canonical[rot] = rot;
+        for (int other = 0; other < rot; other++) {
+            if (sameShape(&piece->pieceT.geometry[other], geom)) {
+                canonical[rot] = other;
+                break;
+            }
+        }
+        dx[rot] = geom->minCol - piece->pieceT.geometry[canonical[rot]].minCol;
+        dy[rot] = geom->minRow - piece->pieceT.geometry[canonical[rot]].minRow;
+    }
+
+    int width = search->width;
+    int bytes = (search->nstates + 7) / 8;
+    memset(search->visited, 0, bytes);
+    memset(search->locked, 0, bytes);
+
+    // state number: ((y + PIECE_GRID - 1) * width + (x + PIECE_GRID - 1)) * 4 + rotation
+    int origin = PIECE_GRID - 1;
+    int start = ((piece->y + origin) * width + (piece->x + origin)) * 4 + piece->rotation;
+    BIT_SET(search->visited, start);
+    search->queue[0] = start;
+    int head = 0, tail = 1;
+    int count = 0;
+
+    while (head < tail) {
+        int current = search->queue[head++];
+        int rot = current & 3;
+        int x = (current >> 2) % width - origin;
+        int y = (current >> 2) / width - origin;
+
+        // left, right and rotate: each new state is tested once, and queued if the piece fits there
+        static const signed char moves[3][2] = {{-1, 0}, {1, 0}, {0, 1}};
+        for (int m = 0; m < 3; m++) {
+            int nx = x + moves[m][0];
+            int nrot = (rot + moves[m][1]) & 3;
+            if (nx + origin < 0 || nx + origin >= width) continue;
+            int next = ((y + origin) * width + (nx + origin)) * 4 + nrot;
+            if (BIT_TEST(search->visited, next)) continue;
+            BIT_SET(search->visited, next);
+            probe.x = nx;
+            probe.y = y;
+            probe.rotation = nrot;
+            if (game_engine_is_valid_position(state, &probe)) search->queue[tail++] = next;
+        }
+
+        // down: a piece that can't move down locks where it is
+        probe.x = x;
+        probe.y = y + 1;
+        probe.rotation = rot;
+        if (y + 1 + origin < search->height && game_engine_is_valid_position(state, &probe)) {
+            int next = current + width * 4;
+            if (!BIT_TEST(search->visited, next)) {
+                BIT_SET(search->visited, next);
+                search->queue[tail++] = next;
+            }
+            continue;
+        }
+
+        // record the position unless an equivalent one (same squares) was recorded already
+        int cx = x + dx[rot];
+        int cy = y + dy[rot];
+        int key = ((cy + origin) * width + (cx + origin)) * 4 + canonical[rot];
+        if (BIT_TEST(search->locked, key) || count == max) continue;
+        BIT_SET(search->locked, key);
+        out[count].x = cx;
+        out[count].y = cy;
+        out[count].rotation = canonical[rot];
+        count++;
+    }
+    return count;
+}
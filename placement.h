@@ -0,0 +1,48 @@
+#ifndef _PLACEMENT_H
+#define _PLACEMENT_H
+
+#include <stdbool.h>
+#include "game_engine.h"
+
+/* Reachable placements: every position where a falling piece can lock, given the moves the game allows (left,
+right, down, rotate) from where the piece is now. Pieces can still slide and rotate once they rest on the stack
+(tucks, see game_input.h), so these aren't just straight drops from the top: a breadth-first search walks the
+piece states (x, y, rotation) using the engine's collision tests and a visited bitmap.
+Positions that cover the same squares (the rotations of an 'o', say) are returned once.
+*/
+typedef struct {
+    signed char x;
+    signed char rotation;
+    short y;
+} placement_t;
+
+// Piece states of an nrows x ncols board: x and y each take (size + PIECE_GRID - 1) values, times 4 rotations
+#define PLACEMENT_STATES(nrows, ncols) (((nrows) + PIECE_GRID - 1) * ((ncols) + PIECE_GRID - 1) * 4)
+
+// Search workspace for boards of one size: set up once, reused by every placement_enumerate (the arrays live
+// inside the struct in a STATIC_BOARD build, and come from the heap otherwise)
+typedef struct {
+    int nrows;
+    int ncols;
+    int width;                  // x positions a piece can take, and likewise y positions
+    int height;
+    int nstates;
+#ifdef STATIC_BOARD
+    unsigned char visited[(PLACEMENT_STATES(NROWS, NCOLS) + 7) / 8];
+    unsigned char locked[(PLACEMENT_STATES(NROWS, NCOLS) + 7) / 8];
+    short queue[PLACEMENT_STATES(NROWS, NCOLS)];
+#else
+    unsigned char* visited;     // bitmap of states already tested
+    unsigned char* locked;      // bitmap of lock positions already returned
+    short* queue;               // states reached but not yet expanded, in the order they were reached
+#endif
+} placement_search_t;
+
+void placement_init(placement_search_t* search, int nrows, int ncols);
+
+void placement_free(placement_search_t* search);
+
+int placement_enumerate(placement_search_t* search, const game_state_t* state, const falling_piece_t* piece,
+                        placement_t* out, int max);
+
+#endif
@@ -6,42 +6,133 @@
 * a random bag! 
 * Citation: Julie, for giving us this awesome question on our CS106B exam in Fall 2023,
 * while inspired my O(1) logic here! :)
+* Each random_bag_t carries its own random number state (seeded once), so several games can run side by side;
+* the random_bag_init/random_bag_choose functions use a single bag seeded from the timer (or a given seed).
+* Random numbers come from xorshift32: a few shifts and xors per number, no division, and the same sequence for
+* the same seed on the device and the host.
 */
 
 #include "random_bag.h"
 #include "timer.h"
-#define BAG_SIZE 28
 #define NUM_ELEMS 7
 
-static struct {
-    int random_bag[BAG_SIZE];
-    int size;
-} rand_bag;
+static random_bag_t rand_bag;
 
-// Required init
-void random_bag_init(void) {
-    for (int i = 0; i < BAG_SIZE; i++) {
-        rand_bag.random_bag[i] = i % NUM_ELEMS;
+// Helper to refill bag with BAG_COPIES copies of each element (as many as fit, for large sets), or one copy of
+// each for BAG_POLICY_SINGLE
+static void refill(random_bag_t* bag) {
+    int copies = (bag->policy == BAG_POLICY_SINGLE) ? 1 : BAG_CAPACITY / bag->nelems;
+    if (copies > BAG_COPIES) copies = BAG_COPIES;
+    bag->size = copies * bag->nelems;
+    for (int i = 0; i < bag->size; i++) {
+        bag->items[i] = i % bag->nelems;
     }
-    rand_bag.size = BAG_SIZE;
 }
 
-bool random_bag_isEmpty(void) {
-    return (rand_bag.size == 0);
+// Helper to advance the bag's random number state (xorshift32)
+static unsigned int nextRandom(random_bag_t* bag) {
+    unsigned int x = bag->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    bag->state = x;
+    return x;
+}
+
+// Helper to pick a random index below n: scales the 32-bit random number by n instead of dividing
+static int randomBelow(random_bag_t* bag, int n) {
+    return (int)(((unsigned long)nextRandom(bag) * (unsigned int)n) >> 32);
+}
+
+// Helper to turn a seed into a starting state, so nearby seeds (e.g. consecutive games) start far apart and
+// seed 0 doesn't give the all-zero state xorshift can't leave
+static unsigned int mixSeed(unsigned int seed) {
+    seed ^= seed >> 16;
+    seed *= 0x45D9F3B;
+    seed ^= seed >> 16;
+    seed *= 0x45D9F3B;
+    seed ^= seed >> 16;
+    return seed ? seed : 1;
+}
+
+// Required init for a bag of nelems elements dealt by policy, with its own random number state;
+// same seed -> same sequence of elements
+void random_bag_init_with_policy(random_bag_t* bag, unsigned int seed, int nelems, bag_policy_t policy) {
+    bag->nelems = nelems;
+    bag->policy = policy;
+    bag->size = 0;
+    if (policy != BAG_POLICY_HISTORY) refill(bag);
+    for (int i = 0; i < BAG_HISTORY_SIZE; i++) bag->history[i] = 0xFF;    // nothing dealt yet
+    bag->seed = seed;
+    bag->state = mixSeed(seed);
+}
+
+// Required init for a bag of nelems elements (BAG_POLICY_MULTI)
+void random_bag_init_seeded(random_bag_t* bag, unsigned int seed, int nelems) {
+    random_bag_init_with_policy(bag, seed, nelems, BAG_POLICY_MULTI);
+}
+
+// Returns the seed bag was initialized with: a bag initialized with it again deals the same elements
+unsigned int random_bag_seed(const random_bag_t* bag) {
+    return bag->seed;
+}
+
+bool random_bag_is_empty(const random_bag_t* bag) {
+    return (bag->size == 0);
 }
 
-// Returns randomly chosen element (as a number ranging from 0 to NUM_ELEMS) from random bag
+// Helper to check whether element is one of the last BAG_HISTORY_SIZE elements dealt
+static bool inHistory(const random_bag_t* bag, int element) {
+    for (int i = 0; i < BAG_HISTORY_SIZE; i++) {
+        if (bag->history[i] == element) return true;
+    }
+    return false;
+}
+
+// Helper for BAG_POLICY_HISTORY: draws until the element isn't one of the last few dealt (or out of tries)
+static int chooseWithHistory(random_bag_t* bag) {
+    int chosen = randomBelow(bag, bag->nelems);
+    for (int tries = 1; tries < BAG_HISTORY_TRIES && inHistory(bag, chosen); tries++) {
+        chosen = randomBelow(bag, bag->nelems);
+    }
+    for (int i = BAG_HISTORY_SIZE - 1; i > 0; i--) bag->history[i] = bag->history[i - 1];
+    bag->history[0] = chosen;
+    return chosen;
+}
+
+// Returns randomly chosen element (as a number ranging from 0 to nelems - 1) from random bag
 // If bag is empty, the random bag is replenished before an element is chosen.
-int random_bag_choose(void) {
-    if (random_bag_isEmpty()) {
-        random_bag_init();      // replenish random bag by resetting state
+int random_bag_choose_from(random_bag_t* bag) {
+    if (bag->policy == BAG_POLICY_HISTORY) return chooseWithHistory(bag);
+    if (random_bag_is_empty(bag)) {
+        refill(bag);      // replenish random bag by resetting state
     }
-    int randInd = timer_get_ticks() % rand_bag.size;
-    int chosen = rand_bag.random_bag[randInd];
+    int randInd = randomBelow(bag, bag->size);
+    int chosen = bag->items[randInd];
     // Shifting of last element in random_bag array to ensure all elements are colocated in array and performance is optimized!
-    if (randInd != (rand_bag.size - 1)) {
-        rand_bag.random_bag[randInd] = rand_bag.random_bag[rand_bag.size - 1];
-    }
-    rand_bag.size--;
+    bag->items[randInd] = bag->items[bag->size - 1];
+    bag->size--;
     return chosen;
-}   
\ No newline at end of file
+}
+
+// Required init
+void random_bag_init(void) {
+    random_bag_init_seeded(&rand_bag, timer_get_ticks(), NUM_ELEMS);
+}
+
+// Init with a given seed, e.g. to deal the pieces of an earlier run again (see random_bag_get_seed)
+void random_bag_init_with_seed(unsigned int seed) {
+    random_bag_init_seeded(&rand_bag, seed, NUM_ELEMS);
+}
+
+unsigned int random_bag_get_seed(void) {
+    return random_bag_seed(&rand_bag);
+}
+
+bool random_bag_isEmpty(void) {
+    return random_bag_is_empty(&rand_bag);
+}
+
+int random_bag_choose(void) {
+    return random_bag_choose_from(&rand_bag);
+}
@@ -3,9 +3,42 @@
 
 #include <stdbool.h>
 
+#define BAG_CAPACITY 64
+#define BAG_COPIES 4        // copies of each element in a full bag (fewer for more than BAG_CAPACITY / 4 elements)
+#define BAG_HISTORY_SIZE 4  // elements remembered by BAG_POLICY_HISTORY
+#define BAG_HISTORY_TRIES 4 // draws BAG_POLICY_HISTORY makes before accepting a recently dealt element
+
+// How a bag deals its elements. Every policy draws in O(1): one random number per draw (at most BAG_HISTORY_TRIES
+// for BAG_POLICY_HISTORY) and no searching.
+typedef enum {
+    BAG_POLICY_MULTI = 0,   // bags of BAG_COPIES copies of each element (the original 28-piece bag for 7 pieces)
+    BAG_POLICY_SINGLE,      // bags of one copy of each element (the "7-bag" for 7 pieces)
+    BAG_POLICY_HISTORY,     // no bag: independent draws, redrawn if among the last BAG_HISTORY_SIZE elements dealt
+} bag_policy_t;
+
+// A random bag of elements 0 through nelems - 1 (up to BAG_CAPACITY of them) with its own random number state,
+// so every game instance can draw from its own bag. The sequence of elements depends only on the seed, nelems and
+// the policy, so a game's pieces can be dealt again from its seed.
+typedef struct {
+    unsigned char items[BAG_CAPACITY];  // elements are piece indices, so a byte each keeps bags small to copy
+    int size;
+    int nelems;
+    bag_policy_t policy;
+    unsigned char history[BAG_HISTORY_SIZE];    // last elements dealt (BAG_POLICY_HISTORY), most recent first
+    unsigned int state;                 // xorshift32 state, never 0
+    unsigned int seed;                  // seed the bag was initialized with
+} random_bag_t;
+
 void random_bag_init(void);
+void random_bag_init_with_seed(unsigned int seed);
+unsigned int random_bag_get_seed(void);
 bool random_bag_isEmpty(void);
 int random_bag_choose(void);
 
+void random_bag_init_seeded(random_bag_t* bag, unsigned int seed, int nelems);
+void random_bag_init_with_policy(random_bag_t* bag, unsigned int seed, int nelems, bag_policy_t policy);
+unsigned int random_bag_seed(const random_bag_t* bag);
+bool random_bag_is_empty(const random_bag_t* bag);
+int random_bag_choose_from(random_bag_t* bag);
+
 #endif
- 
@@ -19,6 +19,17 @@
 
 static remote_t remote ;
 
+// scripted inputs (remote_script_start): the step being played and where the next one starts
+static struct {
+    const char *script ;    // NULL -> inputs come from the remote
+    const char *next ;
+    int repeats ;           // times left to start the script over once it runs out
+    int polls ;             // polls left in the current step
+    int x, y ;              // tilt of the current step
+    int presses ;           // button presses of the current step not yet taken
+    bool done ;
+} script ;
+
 // 'handle_button'
 // handles a button press 
 static void handle_button(uintptr_t pc, void *aux_data) {
@@ -33,14 +44,93 @@ static void handle_button(uintptr_t pc, void *aux_data) {
 // checks if there are presses in the queue
 bool remote_is_button_press(void) {
     int k = 0 ;
+    if (script.script != NULL) {
+        if (script.presses == 0) return false ;
+        script.presses-- ;
+        servo_vibrate_async(100) ; // same buzz as a real press
+        return true ;
+    }
     if (!(rb_empty(remote.rb))) {
-        servo_vibrate_milli_sec(100) ;
+        servo_vibrate_async(100) ; // buzz without holding up the game loop
         rb_dequeue(remote.rb, &k) ;
         return true ;
     }
     return false ;
 }
 
+// 'next_step'
+// parses the next step of the script (starting it over if it has repeats left); the remote stays level once it's done
+static void next_step(void) {
+    script.x = X_HOME ;
+    script.y = HOME ;
+    script.presses = 0 ;    // presses a step's polls didn't read don't carry over into the next one
+    while (!script.done) {
+        const char *c = script.next ;
+        while (*c == ' ' || *c == '\t' || *c == '\n' || *c == '\r' || *c == ',' || *c == '#') {
+            if (*c == '#') while (*c != '\0' && *c != '\n') c++ ;
+            else c++ ;
+        }
+        if (*c == '\0') {
+            if (--script.repeats <= 0 || c == script.script) script.done = true ;
+            script.next = script.script ;
+            continue ;
+        }
+        int count = 0 ;
+        while (*c >= '0' && *c <= '9') count = 10 * count + (*c++ - '0') ;
+        script.polls = (count > 0) ? count : 1 ;
+        for ( ; *c != '\0' && *c != ' ' && *c != '\t' && *c != '\n' && *c != '\r' && *c != ','; c++) {
+            if (*c == 'L') script.y = LEFT ;
+            else if (*c == 'R') script.y = RIGHT ;
+            else if (*c == 'F') script.x = X_FAST ;
+            else if (*c == 'S') script.x = X_SWAP ;
+            else if (*c == 'P') script.presses++ ;
+        }
+        script.next = c ;
+        return ;
+    }
+}
+
+// 'remote_script_start'
+// plays script instead of the remote's inputs (NULL script -> the real remote again)
+void remote_script_start(const char *script_text, int repeats) {
+    script.script = script_text ;
+    script.next = script_text ;
+    script.repeats = (repeats < 1) ? 1 : repeats ;
+    script.polls = 0 ;
+    script.presses = 0 ;
+    script.x = X_HOME ;
+    script.y = HOME ;
+    script.done = false ;
+}
+
+// 'remote_script_done'
+// checks if the script playing has run out
+bool remote_script_done(void) {
+    return script.script != NULL && script.done && script.polls == 0 ;
+}
+
+// 'remote_script_receive'
+// reads a script over uart up to a line "end"
+int remote_script_receive(char *buf, int max) {
+    int len = 0 ;
+    int line = 0 ; // start of the current line
+    while (len < max - 1) {
+        char c = uart_getchar() ;
+        if (c == '\n' || c == '\r') {
+            if (len - line == 3 && buf[line] == 'e' && buf[line + 1] == 'n' && buf[line + 2] == 'd') {
+                len = line ;
+                break ;
+            }
+            buf[len++] = '\n' ;
+            line = len ;
+            continue ;
+        }
+        buf[len++] = c ;
+    }
+    buf[len] = '\0' ;
+    return len ;
+}
+
 // 'remote_init'
 // initializes button, servo, i2c, accelerometer, and interrupts for button
 void remote_init(gpio_id_t servo_id, gpio_id_t button_id, gpio_id_t buzzer_id, int music_tempo) {
@@ -58,7 +148,7 @@ void remote_init(gpio_id_t servo_id, gpio_id_t button_id, gpio_id_t buzzer_id, i
 	lsm6ds33_init();
 
     remote.buzzer = buzzer_id ;    
-    buzzer_intr_init(buzzer_id, music_tempo) ; // this uses both timer0 and timer1 for the pwm and note-change :)
+    buzzer_intr_init(buzzer_id, music_tempo) ; // timer0 for the pwm, a timer wheel timer (timer1) for the note-change :)
 
     gpio_interrupt_init() ;
     gpio_interrupt_config(remote.button, GPIO_INTERRUPT_POSITIVE_EDGE, true) ; // if pressed
@@ -73,9 +163,22 @@ void remote_vibrate(int duration_sec) {
     servo_vibrate(duration_sec) ;
 }
 
+// 'remote_vibrate_async'
+// vibrates the most recently configured servo in the background (timer wheel driven)
+void remote_vibrate_async(int duration_milli_sec) {
+    servo_vibrate_async(duration_milli_sec) ;
+}
+
 // 'remote_get_x_y_status'
 // returns int enum "left/right/home" ... enum defined in lsd6ds33.h
 void remote_get_x_y_status(int *x_mod, int *y_mod) {
+    if (script.script != NULL) {
+        if (script.polls == 0) next_step() ;
+        if (script.polls > 0) script.polls-- ;
+        *x_mod = script.x ;
+        *y_mod = script.y ;
+        return ;
+    }
     short x=0; short y=0; 
     lsm6ds33_read_durable_pos(&x, &y, x_mod, y_mod) ; // read and print avged positions
 }
@@ -47,6 +47,12 @@ bool remote_is_button_press(void) ;
 */
 void remote_vibrate(int duration_sec) ;
 
+/* remote_vibrate_async
+ * @param int duration_milli_sec - duration of remote vibration in ms
+ * @functionality - starts the servo vibrating for duration_milli_sec ms and returns right away
+*/
+void remote_vibrate_async(int duration_milli_sec) ;
+
 /* remote_get_x_y_status
  * @param int *x, int *y - user-passed ints to receive data about x and y positions from accelerometer
  * @return - technically, through the params
@@ -56,4 +62,30 @@ void remote_vibrate(int duration_sec) ;
 */
 void remote_get_x_y_status(int *x, int *y) ;
 
+/* remote_script_start
+ * @param const char *script - inputs to play instead of the remote's (NULL -> back to the real remote)
+ * @param int repeats - times to play the script through (at least once)
+ * @functionality - from now on remote_get_x_y_status and remote_is_button_press take their inputs from script, one
+ *                -         step per remote_get_x_y_status call (the game loop's input poll), so a run gets the same
+ *                -         inputs however fast it goes. the script is whitespace separated steps, each an optional
+ *                -         count of polls (default 1) followed by what the remote does for them:
+ *                -         L / R = tilt left / right, F = tilt fast, S = tilt swap, . = level,
+ *                -         P = one button press (at the step's first poll; PP = two presses, ...)
+ *                -         e.g. "40. 3L 2P 20F" ('#' comments out the rest of a line)
+ *                -         the script isn't copied: it has to stay around until the run is over
+*/
+void remote_script_start(const char *script, int repeats) ;
+
+/* remote_script_done
+ * @return - whether a script is playing and has run out of steps (the remote stays level, with no presses, after it)
+*/
+bool remote_script_done(void) ;
+
+/* remote_script_receive
+ * @param char *buf, int max - buffer to receive the script into
+ * @return - length of the script received (up to max - 1 characters, null terminated)
+ * @functionality - reads a script streamed over UART, up to a line with just "end" (or max - 1 characters)
+*/
+int remote_script_receive(char *buf, int max) ;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,224 @@
+/* replay.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The replay.c module records the inputs of a game into a compact replay (see replay.h) and plays replays back
+* headless, through the engine's own moves, lock and spawn. Nothing here draws or waits, so the same code records
+* on the device and re-simulates on the host.
+*/
+
+#include "replay.h"
+#include "board.h"
+#include <stddef.h>
+
+#define REPLAY_MAGIC0 'R'
+#define REPLAY_MAGIC1 'P'
+#define REPLAY_VERSION 1
+#define ARG_BITS 5
+#define ARG_ESCAPE 31               // tick delta too large for the argument: a varint follows
+#define MAX_DOWN_RUN 32
+
+// Required init: an empty replay of the game state (just spawned or about to be), dealt from seed
+void replay_init(replay_t* replay, const game_state_t* state, unsigned int seed) {
+    replay->seed = seed;
+    replay->set = (state->set == &pentomino_set) ? 1 : 0;
+    replay->nrows = GAME_NROWS(state);
+    replay->ncols = GAME_NCOLS(state);
+    replay->complete = true;
+    replay->length = 0;
+    replay->tick = 0;
+    replay->downRun = 0;
+    replay->pieces = 0;
+    replay->finished = false;
+    replay->score = replay->lines = 0;
+    replay->hash = 0;
+}
+
+// Helper to append n bytes; a replay without room for them (and the REPLAY_END after them) stops recording
+static bool putBytes(replay_t* replay, const unsigned char* bytes, int n) {
+    if (!replay->complete || replay->length + n + 1 > REPLAY_MAX_BYTES) {
+        replay->complete = false;
+        return false;
+    }
+    for (int i = 0; i < n; i++) replay->bytes[replay->length++] = bytes[i];
+    return true;
+}
+
+// Helper to write out the pending REPLAY_DOWN run
+static void flushDown(replay_t* replay) {
+    if (replay->downRun == 0) return;
+    unsigned char byte = (REPLAY_DOWN << ARG_BITS) | (replay->downRun - 1);
+    putBytes(replay, &byte, 1);
+    replay->downRun = 0;
+}
+
+// Helper to write a timed input: its byte, then the tick delta as a varint if it doesn't fit the argument
+static void putTimed(replay_t* replay, replay_input_t input, unsigned long tick, const unsigned char* extra, int nextra) {
+    flushDown(replay);
+    unsigned long delta = (tick > replay->tick) ? tick - replay->tick : 0;
+    unsigned char bytes[16];
+    int n = 0;
+    bytes[n++] = (input << ARG_BITS) | ((delta < ARG_ESCAPE) ? delta : ARG_ESCAPE);
+    if (delta >= ARG_ESCAPE) {
+        for (delta -= ARG_ESCAPE; delta >= 0x80; delta >>= 7) bytes[n++] = (delta & 0x7F) | 0x80;
+        bytes[n++] = delta;
+    }
+    for (int i = 0; i < nextra; i++) bytes[n++] = extra[i];
+    if (putBytes(replay, bytes, n)) replay->tick = tick;
+}
+
+// Records an input that changed the game (REPLAY_DOWN through REPLAY_LOCK) at input tick `tick`. Down moves
+// are written as runs, so a piece falling ten rows takes one byte.
+void replay_record(replay_t* replay, replay_input_t input, unsigned long tick) {
+    if (replay->finished) return;
+    if (input == REPLAY_DOWN) {
+        if (++replay->downRun == MAX_DOWN_RUN) flushDown(replay);
+        return;
+    }
+    if (input == REPLAY_LOCK) replay->pieces++;
+    putTimed(replay, input, tick, NULL, 0);
+}
+
+// Records the falling piece being put straight at placement (x, y, rotation), as the autopilot does
+void replay_record_place(replay_t* replay, int x, int y, int rotation, unsigned long tick) {
+    if (replay->finished) return;
+    unsigned char placement[3] = {x, y, rotation};
+    putTimed(replay, REPLAY_PLACE, tick, placement, 3);
+}
+
+// Ends the replay with the game's final state (its score, lines and hash); nothing is recorded after this
+void replay_finish(replay_t* replay, const game_state_t* state) {
+    if (replay->finished) return;
+    flushDown(replay);
+    replay->bytes[replay->length++] = REPLAY_END << ARG_BITS;     // putBytes always leaves room for it
+    replay->score = state->score;
+    replay->lines = state->linesCleared;
+    replay->hash = replay_hash(state);
+    replay->finished = true;
+}
+
+// Returns a hash (FNV-1a) of everything a replay has to reproduce: board squares, score, lines, the next piece
+// and whether the game is over. The falling piece isn't included: the game on screen moves a copy of it.
+unsigned int replay_hash(const game_state_t* state) {
+    unsigned int hash = 2166136261u;
+    for (int y = 0; y < GAME_NROWS(state); y++) {
+        for (int x = 0; x < GAME_NCOLS(state); x++) {
+            hash = (hash ^ board_get_square(&state->board, x, y)) * 16777619u;
+        }
+    }
+    int values[4] = {state->score, state->linesCleared, game_engine_peek(state, 0)->id, state->gameOver};
+    for (int i = 0; i < 4; i++) hash = (hash ^ (unsigned int)values[i]) * 16777619u;
+    return hash;
+}
+
+/* Plays replay back on state (a new game, dealt from the replay's seed; free it with game_engine_free), as fast as
+it goes. Returns the number of pieces locked, or -1 if the replay's inputs are malformed.
+*/
+int replay_play(const replay_t* replay, game_state_t* state) {
+    game_engine_init_with_set(state, replay->set ? &pentomino_set : &tetromino_set, replay->nrows, replay->ncols, replay->seed);
+    game_engine_spawn(state);
+    falling_piece_t* piece = &state->piece;
+    int pieces = 0;
+    for (int pos = 0; pos < replay->length && !state->gameOver; ) {
+        unsigned char byte = replay->bytes[pos++];
+        int input = byte >> ARG_BITS;
+        int arg = byte & ((1 << ARG_BITS) - 1);
+        if (input == REPLAY_DOWN) {
+            for (int rows = arg + 1; rows > 0; rows--) game_engine_move(state, piece, 0, 1);
+            continue;
+        }
+        if (input == REPLAY_END) break;
+        if (arg == ARG_ESCAPE) {
+            while (pos < replay->length && (replay->bytes[pos] & 0x80)) pos++;
+            pos++;      // timing doesn't matter to the game itself
+        }
+        switch (input) {
+            case REPLAY_LEFT:
+                game_engine_move(state, piece, -1, 0);
+                break;
+            case REPLAY_RIGHT:
+                game_engine_move(state, piece, 1, 0);
+                break;
+            case REPLAY_ROTATE:
+                game_engine_rotate(state, piece);
+                break;
+            case REPLAY_SWAP:
+                game_engine_swap(state, piece);
+                break;
+            case REPLAY_LOCK:
+                game_engine_lock(state, piece);
+                game_engine_spawn(state);
+                pieces++;
+                break;
+            case REPLAY_PLACE:
+                if (pos + 3 > replay->length) return -1;
+                piece->x = (signed char)replay->bytes[pos];
+                piece->y = (signed char)replay->bytes[pos + 1];
+                piece->rotation = replay->bytes[pos + 2];
+                pos += 3;
+                if (!game_engine_is_valid_position(state, piece)) return -1;
+                game_engine_has_fallen(state, piece);
+                break;
+        }
+        if (pos > replay->length) return -1;
+    }
+    return pieces;
+}
+
+// Helpers to write and read little-endian integers of n bytes
+static void putLE(unsigned char* out, unsigned int value, int n) {
+    for (int i = 0; i < n; i++) out[i] = value >> (8 * i);
+}
+
+static unsigned int getLE(const unsigned char* in, int n) {
+    unsigned int value = 0;
+    for (int i = 0; i < n; i++) value |= (unsigned int)in[i] << (8 * i);
+    return value;
+}
+
+/* Writes the finished replay to out as REPLAY_HEADER_BYTES of header (magic, version, set, board size, complete
+flag, seed, score, lines, pieces, hash, input length) followed by the inputs. Returns the bytes written, or 0 if
+out is too small.
+*/
+int replay_serialize(const replay_t* replay, unsigned char* out, int max) {
+    if (REPLAY_HEADER_BYTES + replay->length > max) return 0;
+    out[0] = REPLAY_MAGIC0;
+    out[1] = REPLAY_MAGIC1;
+    out[2] = REPLAY_VERSION;
+    out[3] = replay->set;
+    out[4] = replay->nrows;
+    out[5] = replay->ncols;
+    out[6] = replay->complete;
+    out[7] = 0;
+    putLE(out + 8, replay->seed, 4);
+    putLE(out + 12, replay->score, 4);
+    putLE(out + 16, replay->lines, 2);
+    putLE(out + 18, replay->pieces, 2);
+    putLE(out + 20, replay->hash, 4);
+    putLE(out + 24, replay->length, 4);
+    for (int i = 0; i < replay->length; i++) out[REPLAY_HEADER_BYTES + i] = replay->bytes[i];
+    return REPLAY_HEADER_BYTES + replay->length;
+}
+
+// Reads a replay written by replay_serialize; false if in isn't one, or holds a game replay_play can't set up
+bool replay_deserialize(replay_t* replay, const unsigned char* in, int length) {
+    if (length < REPLAY_HEADER_BYTES || in[0] != REPLAY_MAGIC0 || in[1] != REPLAY_MAGIC1 || in[2] != REPLAY_VERSION) return false;
+    unsigned int inputs = getLE(in + 24, 4);
+    if (inputs > REPLAY_MAX_BYTES || REPLAY_HEADER_BYTES + inputs > (unsigned int)length || in[3] > 1) return false;
+    if (in[4] == 0 || in[5] == 0 || in[5] > PACKED_PIECE_MAX_COLS) return false;
+    replay->set = in[3];
+    replay->nrows = in[4];
+    replay->ncols = in[5];
+    replay->complete = in[6];
+    replay->seed = getLE(in + 8, 4);
+    replay->score = getLE(in + 12, 4);
+    replay->lines = getLE(in + 16, 2);
+    replay->pieces = getLE(in + 18, 2);
+    replay->hash = getLE(in + 20, 4);
+    replay->length = inputs;
+    replay->tick = 0;
+    replay->downRun = 0;
+    replay->finished = true;
+    for (int i = 0; i < inputs; i++) replay->bytes[i] = in[REPLAY_HEADER_BYTES + i];
+    return true;
+}
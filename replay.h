@@ -0,0 +1,68 @@
+#ifndef _REPLAY_H
+#define _REPLAY_H
+
+#include <stdbool.h>
+#include "game_engine.h"
+
+/* Replays: a game kept as the seed its pieces were dealt from plus the inputs that changed it, compact enough to
+keep every game (a few bytes per piece). Only inputs that did something are recorded: a move into a wall or a
+gravity tick on a resting piece changes nothing, so it isn't there. Each input is one byte, the input in the top 3
+bits and a 5 bit argument:
+    REPLAY_DOWN             rows moved down in a row, minus 1 (gravity and soft drop; longer runs take more bytes)
+    REPLAY_LEFT ... LOCK    input ticks (REPLAY_TICK_US) since the previous timed input; 31 -> the delta minus 31
+                            follows as a varint (7 bits per byte, low bits first, high bit set on all but the last)
+    REPLAY_PLACE            as above, then the placement's x, y and rotation, one byte each (autopilot moves)
+    REPLAY_END              end of the game
+Playing the inputs back on a game dealt from the same seed (replay_play) reaches the same final state, which the
+replay holds a hash of (replay_hash).
+*/
+typedef enum {
+    REPLAY_DOWN = 0,
+    REPLAY_LEFT,
+    REPLAY_RIGHT,
+    REPLAY_ROTATE,
+    REPLAY_SWAP,
+    REPLAY_LOCK,        // the piece locks where it is, then the next one spawns
+    REPLAY_PLACE,
+    REPLAY_END,
+} replay_input_t;
+
+#define REPLAY_TICK_US 5000             // the game loop's input polling period
+#define REPLAY_MAX_BYTES 16384          // inputs of one replay; a longer game keeps its first REPLAY_MAX_BYTES
+#define REPLAY_HEADER_BYTES 28          // header of the serialized form (replay_serialize)
+
+typedef struct {
+    unsigned int seed;
+    unsigned char set;                  // piece set: 0 tetrominoes, 1 pentominoes
+    unsigned char nrows;
+    unsigned char ncols;
+    bool complete;                      // false -> the replay ran out of room or the game took an input it can't hold
+    int length;                         // bytes of inputs
+    unsigned long tick;                 // tick of the last timed input
+    int downRun;                        // rows of a REPLAY_DOWN run not written yet
+    int pieces;                         // pieces locked
+    // final state, filled in by replay_finish
+    bool finished;
+    int score;
+    int lines;
+    unsigned int hash;
+    unsigned char bytes[REPLAY_MAX_BYTES];
+} replay_t;
+
+void replay_init(replay_t* replay, const game_state_t* state, unsigned int seed);
+
+void replay_record(replay_t* replay, replay_input_t input, unsigned long tick);
+
+void replay_record_place(replay_t* replay, int x, int y, int rotation, unsigned long tick);
+
+void replay_finish(replay_t* replay, const game_state_t* state);
+
+unsigned int replay_hash(const game_state_t* state);
+
+int replay_play(const replay_t* replay, game_state_t* state);
+
+int replay_serialize(const replay_t* replay, unsigned char* out, int max);
+
+bool replay_deserialize(replay_t* replay, const unsigned char* in, int length);
+
+#endif
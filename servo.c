@@ -5,11 +5,21 @@
 
 #include "gpio.h"
 #include "timer.h"
+#include "timer_wheel.h"
+#include <stddef.h>
 
 #define TICKS_PER_USEC 24 // 24 ticks counted per one microsecond
 
 static gpio_id_t servo_id ;
 
+// background vibration (servo_vibrate_async): a timer wheel timer starts a pulse every 20 ms, another ends it
+static struct {
+    sw_timer_t frame ;
+    sw_timer_t pulse ;
+    int frames_left ;
+    int scale ;
+} vibration ;
+
 // 'servo_init'
 // initializes servo
 void servo_init(gpio_id_t id) {
@@ -50,3 +60,33 @@ void servo_vibrate_milli_sec(int duration_milli_sec) {
         servo_turn(-1) ;
     }
 }
+
+// 'end_pulse'
+// timer wheel callback: ends the current servo pulse
+static void end_pulse(void *aux_data) {
+    gpio_write(servo_id, 0) ;
+}
+
+// 'start_pulse'
+// timer wheel callback (every 20 ms): starts the next pulse of a background vibration, alternating between
+// the two end positions like servo_vibrate does, and stops once the vibration's time is up
+static void start_pulse(void *aux_data) {
+    if (vibration.frames_left <= 0) {
+        timer_wheel_cancel(&vibration.frame) ;
+        return ;
+    }
+    vibration.frames_left-- ;
+    vibration.scale = -vibration.scale ;
+    gpio_write(servo_id, 1) ;
+    timer_wheel_start(&vibration.pulse, 1500 + vibration.scale*(500), 0, end_pulse, NULL) ;
+}
+
+// 'servo_vibrate_async'
+// vibrates like servo_vibrate_milli_sec, but returns right away: the pulses come from timer wheel timers
+// (pulse widths of 1 and 2 ms are whole timer wheel ticks). A new vibration replaces one still running.
+void servo_vibrate_async(int duration_milli_sec) {
+    vibration.frames_left = (duration_milli_sec + 19) / 20 ; // one 20 ms frame per pulse
+    vibration.scale = -1 ;
+    timer_wheel_init() ; // no-op if the wheel is already running
+    timer_wheel_start(&vibration.frame, 0, 20000, start_pulse, NULL) ;
+}
@@ -31,4 +31,11 @@ void servo_vibrate(int duration_sec) ;
 */
 void servo_vibrate_milli_sec(int duration_milli_sec) ;
 
+/* servo_vibrate_async
+ * @param int duration_milli_sec - duration for vibration in ms
+ * @functionality - vibrates like servo_vibrate_milli_sec without waiting: pulses are timed by the timer wheel
+ *                  (timer_wheel.h), so the caller keeps running
+*/
+void servo_vibrate_async(int duration_milli_sec) ;
+
 #endif
\ No newline at end of file
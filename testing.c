@@ -1,6 +1,18 @@
 #include "testing.h"
 
 #include "game_update.h"
+#include "board.h"
+#include "game_engine.h"
+#include "game_input.h"
+#include "game_scheduler.h"
+#include "fixed_point.h"
+#include "timer_wheel.h"
+#include "game_events.h"
+#include "placement.h"
+#include "autoplayer.h"
+#include "replay.h"
+#include "malloc.h"
+#include "strings.h"
 #include "uart.h"
 #include "assert.h"
 #include "timer.h"
@@ -63,8 +75,14 @@ void test_motions(void) {
     game_update_init(20, 10);
     falling_piece_t piece = init_falling_piece();
     while (1) {
-        int ch = get_keystroke("key press to move down (S) / left (A) / right (D) or rotate (R)");
+        int ch = get_keystroke("key press to move down (S) / hard drop (W) / left (A) / right (D) / rotate (R) or undo (U)");
+        if (ch == 'u') {
+            game_update_undo(&piece);
+            continue;
+        }
+        game_update_save_snapshot(&piece);
         if (ch == 's') move_down(&piece);
+        else if (ch == 'w') hard_drop(&piece);
         else if (ch == 'a') move_left(&piece);
         else if (ch == 'd') move_right(&piece);
         else if (ch == 'r') rotate(&piece);
@@ -173,7 +191,7 @@ void integration_test_v2(void) {
 
     while(1) {
         printf ("timer get ticks START(): %ld\n", timer_get_ticks() % n) ;
-        while (timer_get_ticks() % n <= (0.8 * n)) {
+        while (timer_get_ticks() % n <= fix16_scale(n, FIX16_CONST(0.8))) {
             toggle_turns += 1 ;
             // tilt blocks
             remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
@@ -208,7 +226,7 @@ void integration_test_v2(void) {
         printf("\n*** x dropped normal ***\n"); // for debugging
         move_down(&piece);
 
-        while (timer_get_ticks() % n > (0.8 * n)) {
+        while (timer_get_ticks() % n > fix16_scale(n, FIX16_CONST(0.8))) {
             printf("waiting...");
         };
     }
@@ -351,7 +369,7 @@ void integration_test_v3(void) {
         int toggle_turns = 0 ;
 
         while(1) {
-            while (timer_get_ticks() % n <= (0.8 * n)) {
+            while (timer_get_ticks() % n <= fix16_scale(n, FIX16_CONST(0.8))) {
                 toggle_turns += 1 ; toggle_turns %= 3 ; // so we don't overflow
                 // tilt blocks
                 remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
@@ -375,7 +393,7 @@ void integration_test_v3(void) {
             move_down(&piece);
             if (game_update_is_game_over()) {timer_delay(2) ; break ;} // exits game-playing mode if game is over
 
-            while (timer_get_ticks() % n > (0.8 * n)) {
+            while (timer_get_ticks() % n > fix16_scale(n, FIX16_CONST(0.8))) {
                 // RESOLVED WITH passive_buzz_intr.c aditi play music notes in here???
             };
         } 
@@ -420,7 +438,7 @@ void integration_test_v4(void) {
         int music_index = 0 ;
 
         while(1) {
-            while (timer_get_ticks() % n <= (0.8 * n)) {
+            while (timer_get_ticks() % n <= fix16_scale(n, FIX16_CONST(0.8))) {
                 toggle_turns += 1 ; toggle_turns %= 3 ; // so we don't overflow
                 // tilt blocks
                 remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
@@ -447,7 +465,7 @@ void integration_test_v4(void) {
             music_index += 1; music_index %= num_notes; 
             int note_period = (uSEC_IN_SEC / music_notes[music_index]) ; // keep it approximate
 
-            while (timer_get_ticks() % n > (0.8 * n)) {
+            while (timer_get_ticks() % n > fix16_scale(n, FIX16_CONST(0.8))) {
                 // play music notes in here???
                 gpio_write(GPIO_PB6, 1);
                 timer_delay_us(note_period/2);
@@ -527,7 +545,7 @@ void integration_test_v5(void) {
     //     int music_index = 0 ;
 
     //     while(1) {
-    //         while (timer_get_ticks() % n <= (0.8 * n)) {
+    //         while (timer_get_ticks() % n <= fix16_scale(n, FIX16_CONST(0.8))) {
     //             toggle_turns += 1 ; toggle_turns %= 3 ; // so we don't overflow
     //             // tilt blocks
     //             remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
@@ -554,7 +572,7 @@ void integration_test_v5(void) {
     //         music_index += 1; music_index %= num_notes; 
     //         int note_period = (uSEC_IN_SEC / music_notes[music_index]) ; // keep it approximate
 
-    //         while (timer_get_ticks() % n > (0.8 * n)) {};
+    //         while (timer_get_ticks() % n > fix16_scale(n, FIX16_CONST(0.8))) {};
     //     } 
 
     //     game_interlude_print_leaderboard(game_update_get_score(), game_update_get_rows_cleared()) ; 
@@ -588,7 +606,7 @@ void integration_test_v6(void) {
         int toggle_turns = 0 ;
 
         while(1) {
-            while (timer_get_ticks() % n <= (0.8 * n)) {
+            while (timer_get_ticks() % n <= fix16_scale(n, FIX16_CONST(0.8))) {
                 toggle_turns += 1 ; toggle_turns %= (3*9) ; // so we don't overflow
 
                 // get accelerometer readings
@@ -632,7 +650,7 @@ void integration_test_v6(void) {
             move_down(&piece);
             if (game_update_is_game_over()) {timer_delay(2); break;} // exits game-playing mode if game is over
 
-            while (timer_get_ticks() % n > (0.8 * n)) {};
+            while (timer_get_ticks() % n > fix16_scale(n, FIX16_CONST(0.8))) {};
         } 
 
         game_interlude_print_leaderboard(game_update_get_score(), game_update_get_rows_cleared()); 
@@ -694,7 +712,7 @@ void integration_test_v9(void) {
         int toggle_turns = 0 ;
 
         while(1) {
-            while (timer_get_ticks() % n <= (0.8 * n)) {
+            while (timer_get_ticks() % n <= fix16_scale(n, FIX16_CONST(0.8))) {
                 toggle_turns += 1 ; toggle_turns %= (3*9) ; // so we don't overflow
 
                 // get accelerometer readings
@@ -739,7 +757,7 @@ void integration_test_v9(void) {
             move_down(&piece);
             if (game_update_is_game_over()) {timer_delay(2); break;} // exits game-playing mode if game is over
 
-            while (timer_get_ticks() % n > (0.8 * n)) {};
+            while (timer_get_ticks() % n > fix16_scale(n, FIX16_CONST(0.8))) {};
         } 
 
         game_interlude_print_leaderboard(game_update_get_score(), game_update_get_rows_cleared()); 
@@ -748,6 +766,19 @@ void integration_test_v9(void) {
 
 
 // TETRIS THEME interrupt version!
+// Prints the game's replay over UART as one line, "replay: " and the serialized replay in hex (host/replay.c reads
+// replays from a log of such lines)
+static void print_replay(void) {
+    static unsigned char bytes[REPLAY_HEADER_BYTES + REPLAY_MAX_BYTES];
+    const replay_t* replay = game_update_get_replay();
+    int length = replay_serialize(replay, bytes, sizeof(bytes));
+    printf("replay: %d pieces in %d bytes (%d bytes/piece)%s\n", replay->pieces, length,
+           length / (replay->pieces ? replay->pieces : 1), replay->complete ? "" : ", incomplete");
+    printf("replay: ");
+    for (int i = 0; i < length; i++) printf("%02x", bytes[i]);
+    printf("\n");
+}
+
 void integration_test_v10(void) {
     gpio_init() ;
     timer_init() ;
@@ -763,74 +794,1680 @@ void integration_test_v10(void) {
 
     while(1) {
         game_update_init(20, 10);
+        // moves only update the game; the render task draws one frame with all of them (game_update_render)
+        game_update_set_deferred_render(true);
         falling_piece_t piece = init_falling_piece();
         buzzer_intr_set_tempo(TEMPO_ALLEGRO) ;
 
         // write accelerometer x/y position to pitch(x) and roll(y)
         int pitch = 0; int roll = 0;
-        // int n_init = 480 ;
-        long n = 480 ; // total ms wait for each loop
-        n = (n * 1000 * TICKS_PER_USEC);
+        // held inputs repeat (and pieces lock) by time, not by loop count (see game_input.h)
+        input_state_t input;
+        game_input_init(&input, &game_input_default_timing);
 
-        int toggle_turns = 0 ;
-        
         startGame();
 
+        // gravity, input polling and rendering (frames, line clear animation) each run on their own fixed timestep,
+        // and the loop sleeps until the next one is due (see game_scheduler.h). The tasks start once startGame
+        // returns, so time on the start screen isn't counted as late ticks.
+        unsigned long now = timer_get_ticks() / TICKS_PER_USEC;
+        game_task_t gravity, poll, render;
+        game_task_init(&gravity, game_engine_gravity_us(&game_engine_default_gravity, 0), 2, now);
+        game_task_init(&poll, 5000, 1, now);        // 200 Hz: a sensor read and input step each time
+        game_task_init(&render, 16000, 1, now);     // ~60 Hz animation frames
+        game_task_t* const tasks[] = {&gravity, &poll, &render};
+
         while(1) {
-            while (timer_get_ticks() % n <= (0.8 * n)) {
-                toggle_turns += 1 ; toggle_turns %= (3*9) ; // so we don't overflow
+            now = timer_get_ticks() / TICKS_PER_USEC;
+
+            // line clear animation runs while rows are cleared; next piece spawns once rows have dropped
+            bool frameDue = game_task_due(&render, now);
+            if (frameDue && game_update_is_clearing()) {
+                if (game_update_advance_clear()) {
+                    piece = init_falling_piece();
+                    game_input_piece_spawned(&input);
+                }
+            }
 
+            if (game_task_due(&poll, now) && !game_update_is_clearing()) {
                 // get accelerometer readings
                 remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
             
-                if (toggle_turns % 7 == 0) {
-                    if (pitch == X_SWAP) swap(&piece);
-                }
+                if (game_input_swap(&input, pitch == X_SWAP)) swap(&piece);
 
-                // horizontal movement or swap
-                if (toggle_turns % 3 == 0) {
-                    if (roll == LEFT) move_left(&piece);
-                    else if (roll == RIGHT) move_right(&piece); 
+                // horizontal movement: one square on tilt, then auto-repeat while the tilt is held
+                int dir = (roll == LEFT) ? -1 : (roll == RIGHT) ? 1 : 0;
+                for (int moves = game_input_shift(&input, dir, now); moves > 0; moves--) {
+                    if (dir < 0) move_left(&piece);
+                    else move_right(&piece);
                 }
 
                 while (remote_is_button_press()) rotate(&piece);
-                if (piece.fallen) {
-                    remote_get_x_y_status(&pitch, &roll); // the x and y tilt statuses
-            
-                    // horizontal movement
-                    if (roll == LEFT) {
-                        move_left(&piece);
-                    }
-                    else if (roll == RIGHT) {
-                        move_right(&piece); 
-                    }
 
-                    if (iterateVariant(&piece, checkIfFallen)) {
-                        iterateThroughPieceSquares(&piece, update_background);
-                        clearRows(); // inside clear rows: now, we get and update the tempo +=2 for every line cleared
+                // drop a block faster
+                int rows = game_input_soft_drop(&input, pitch == X_FAST, now);
+                if (rows > 0) move_down_by(&piece, rows);
+
+                // a piece resting on the stack can still be tucked until the lock delay is up
+                if (game_input_lock_due(&input, game_update_has_fallen(&piece), now)) {
+                    iterateThroughPieceSquares(&piece, update_background);
+                    clearRows(); // inside clear rows: now, we get and update the tempo +=2 for every line cleared
+                    if (!game_update_is_clearing()) {
                         piece = init_falling_piece();
+                        game_input_piece_spawned(&input);
                     }
                 }
+            }
 
-                // drop a block faster
-                if (pitch == X_FAST) { 
-                    if (!piece.fallen) move_down(&piece);
-                    if (!piece.fallen) move_down(&piece);
+            // gravity speeds up with lines cleared; late ticks are caught up (up to 2 rows at once)
+            for (int ticks = game_task_due(&gravity, now); ticks > 0; ticks--) {
+                if (!game_update_is_clearing()) move_down(&piece);
+            }
+            game_task_set_period(&gravity, game_engine_gravity_us(&game_engine_default_gravity, game_update_get_rows_cleared()));
+
+            // one frame with everything that changed since the last one
+            if (frameDue) game_update_render();
+
+            // vibration, music and other side effects of what happened this iteration, outside the game step
+            game_events_dispatch();
+
+            if (game_update_is_game_over()) {timer_delay(2); break;} // exits game-playing mode if game is over
+
+            // sleep between ticks: the timer wheel's tick interrupt (started by the buzzer) wakes the CPU every ms
+            game_scheduler_idle_until(game_tasks_next_due(tasks, 3), true);
+        } 
+        printf("scheduler: gravity %ld ticks (%ld late, %ld dropped), input %ld polls (%ld dropped), render %ld frames (%ld dropped)\n",
+               gravity.runs, gravity.late, gravity.dropped, poll.runs, poll.dropped, render.runs, render.dropped);
+        printf("frames: %ld rendered for %ld needed\n", game_update_get_frames_rendered(), game_update_get_frames_needed());
+        print_replay();
+        game_update_set_deferred_render(false);
+
+        game_interlude_print_leaderboard(game_update_get_score(), game_update_get_rows_cleared()); 
+    }
+}
+
+// v10 plus the anytime placement search: slices of it run in the loop's idle time, and its best move is drawn as a
+// hint outline -- or, with autopilot, played every AUTOPILOT_MS (the remote still swaps, moves and rotates)
+#define AUTOPILOT_MS 300
+#define SEARCH_MARGIN_US 500        // idle time left for the loop to wake up on time
+void integration_test_v11(bool autopilot) {
+    gpio_init() ;
+    timer_init() ;
+    uart_init() ;
+    interrupts_init() ; // interrupt sandwich start
+    remote_init(GPIO_PB1, GPIO_PB0, GPIO_PB6, TEMPO_ALLEGRO) ;  // buzzer interrupt moved into remote_init
+    interrupts_global_enable() ; // interrupt sandwich end
+    timer_delay(2) ;
+
+    remote_is_button_press() ; // get rid of the extra button press... 
+
+    game_interlude_init(30, 50, GL_WHITE, GL_INDIGO) ; // can do this outside
+    game_update_set_search(true);
+
+    while(1) {
+        game_update_init(20, 10);
+        game_update_set_deferred_render(true);
+        falling_piece_t piece = init_falling_piece();
+        game_update_search_start(&piece);
+        buzzer_intr_set_tempo(TEMPO_ALLEGRO) ;
+
+        int pitch = 0; int roll = 0;
+        input_state_t input;
+        game_input_init(&input, &game_input_default_timing);
+
+        startGame();
+
+        // as in integration_test_v10, the tasks start once the start screen is done
+        unsigned long now = timer_get_ticks() / TICKS_PER_USEC;
+        game_task_t gravity, poll, render, pilot;
+        game_task_init(&gravity, game_engine_gravity_us(&game_engine_default_gravity, 0), 2, now);
+        game_task_init(&poll, 5000, 1, now);
+        game_task_init(&render, 16000, 1, now);
+        game_task_init(&pilot, AUTOPILOT_MS * 1000, 1, now);
+        game_task_t* const tasks[] = {&gravity, &poll, &render, &pilot};
+
+        while(1) {
+            now = timer_get_ticks() / TICKS_PER_USEC;
+
+            bool frameDue = game_task_due(&render, now);
+            if (frameDue && game_update_is_clearing()) {
+                if (game_update_advance_clear()) {
+                    piece = init_falling_piece();
+                    game_input_piece_spawned(&input);
+                    game_update_search_start(&piece);
                 }
-            } 
+            }
+
+            if (game_task_due(&poll, now) && !game_update_is_clearing()) {
+                remote_get_x_y_status(&pitch, &roll);
             
-            move_down(&piece);
-            if (game_update_is_game_over()) {timer_delay(2); break;} // exits game-playing mode if game is over
+                // a swapped in piece needs a search of its own
+                if (game_input_swap(&input, pitch == X_SWAP)) {
+                    swap(&piece);
+                    game_update_search_start(&piece);
+                }
 
-            while (timer_get_ticks() % n > (0.8 * n)) {};
+                int dir = (roll == LEFT) ? -1 : (roll == RIGHT) ? 1 : 0;
+                for (int moves = game_input_shift(&input, dir, now); moves > 0; moves--) {
+                    if (dir < 0) move_left(&piece);
+                    else move_right(&piece);
+                }
+
+                while (remote_is_button_press()) rotate(&piece);
+
+                int rows = game_input_soft_drop(&input, pitch == X_FAST, now);
+                if (rows > 0) move_down_by(&piece, rows);
+
+                // autopilot: the best move found so far goes straight to its placement and locks there
+                bool played = game_task_due(&pilot, now) && autopilot && game_update_autoplay(&piece);
+                if (played || game_input_lock_due(&input, game_update_has_fallen(&piece), now)) {
+                    iterateThroughPieceSquares(&piece, update_background);
+                    clearRows();
+                    if (!game_update_is_clearing()) {
+                        piece = init_falling_piece();
+                        game_input_piece_spawned(&input);
+                        game_update_search_start(&piece);
+                    }
+                }
+            }
+
+            for (int ticks = game_task_due(&gravity, now); ticks > 0; ticks--) {
+                if (!game_update_is_clearing()) move_down(&piece);
+            }
+            game_task_set_period(&gravity, game_engine_gravity_us(&game_engine_default_gravity, game_update_get_rows_cleared()));
+
+            if (frameDue) game_update_render();
+
+            game_events_dispatch();
+
+            if (game_update_is_game_over()) {timer_delay(2); break;}
+
+            // search until shortly before the next task is due, then sleep for whatever is left
+            unsigned long due = game_tasks_next_due(tasks, 4);
+            now = timer_get_ticks() / TICKS_PER_USEC;
+            if (!game_update_is_clearing() && (long)(due - now) > SEARCH_MARGIN_US) {
+                game_update_search_run(due - now - SEARCH_MARGIN_US);
+            }
+            game_scheduler_idle_until(due, true);
         } 
+        unsigned long searched = game_update_get_search_pieces();
+        unsigned long slices = game_update_get_search_slices();
+        printf("search: %ld pieces, %ld nodes/piece, %ld slices/piece, %ld cycles/slice (most %ld)\n", searched,
+               game_update_get_search_nodes() / (searched ? searched : 1), slices / (searched ? searched : 1),
+               game_update_get_search_cycles() / (slices ? slices : 1), game_update_get_search_max_slice_cycles());
+        game_update_set_deferred_render(false);
 
         game_interlude_print_leaderboard(game_update_get_score(), game_update_get_rows_cleared()); 
     }
 }
 
+// Built-in input script for integration_test_v12 (see remote_script_start): each line plays about one piece -- a
+// pause, rotations, a shift of 1 to 4 squares or to the wall (a held tilt repeats after 170 ms, then every 50 ms),
+// a soft drop and a rest on the stack until the piece locks -- spreading the pieces across the board
+const char benchmark_script[] =
+    "10. 80L 90F 60.\n"
+    "10. P 80R 90F 60.\n"
+    "10. 50L 90F 60.\n"
+    "10. 40R 90F 60.\n"
+    "10. PP 1L 90F 60.\n"
+    "10. 60R 90F 60.\n"
+    "10. S 40L 90F 60.\n"
+    "10. P 1R 90F 60.\n"
+    "10. 60L 90F 60.\n"
+    "10. 50R 90F 60.\n";
+
+#define SCRIPT_SEED 107             // every scripted run deals the same pieces
+#define FRAME_BUCKET_US 250         // frame time histogram: 250 usec buckets
+#define FRAME_BUCKETS 64
+
+// v10 on scripted input, as a benchmark that can be compared run to run: the remote's tilt and button presses come
+// from script (NULL -> a script streamed over UART first, up to a line "end"), played repeats times, while the real
+// rendering, audio interrupts and timers run as usual. Games are dealt from fixed seeds, and a game over starts the
+// next game until the script runs out. The run ends with a report over UART: frame times (drawing and swapping one
+// frame), total cycles, and each game's final state (its replay hash), which has to come out the same on every run
+// of the same script.
+void integration_test_v12(const char *script, int repeats) {
+    gpio_init() ;
+    timer_init() ;
+    uart_init() ;
+    interrupts_init() ;
+    remote_init(GPIO_PB1, GPIO_PB0, GPIO_PB6, TEMPO_ALLEGRO) ;
+    interrupts_global_enable() ;
+
+    static char received[16384];
+    if (script == NULL) {
+        printf("send the input script, then a line \"end\"\n");
+        remote_script_receive(received, sizeof(received));
+        script = received;
+    }
+    remote_script_start(script, repeats);
+
+    static unsigned int frameBuckets[FRAME_BUCKETS];
+    memset(frameBuckets, 0, sizeof(frameBuckets));
+    unsigned long frames = 0, frameUsTotal = 0, frameUsMax = 0, frameCycles = 0, frameCyclesMax = 0, iterations = 0;
+    unsigned long startTicks = timer_get_ticks();
+    unsigned long startCycles = game_scheduler_cycles();
+
+    for (int games = 0; !remote_script_done(); games++) {
+        game_update_set_seed(SCRIPT_SEED + games);
+        game_update_init(20, 10);
+        game_update_set_deferred_render(true);
+        falling_piece_t piece = init_falling_piece();
+        buzzer_intr_set_tempo(TEMPO_ALLEGRO) ;
+
+        int pitch = 0; int roll = 0;
+        input_state_t input;
+        game_input_init(&input, &game_input_default_timing);
+
+        unsigned long now = timer_get_ticks() / TICKS_PER_USEC;
+        game_task_t gravity, poll, render;
+        game_task_init(&gravity, game_engine_gravity_us(&game_engine_default_gravity, 0), 2, now);
+        game_task_init(&poll, 5000, 1, now);
+        game_task_init(&render, 16000, 1, now);
+        game_task_t* const tasks[] = {&gravity, &poll, &render};
+
+        while (!game_update_is_game_over() && !remote_script_done()) {
+            // the loop runs on the schedule rather than the clock: each iteration sleeps until the next task is due
+            // and runs it as of its due time, so tasks run in the same order on every run (a late loop only delays
+            // them) and the same script plays the same game
+            now = game_tasks_next_due(tasks, 3);
+            game_scheduler_idle_until(now, true);
+            iterations++;
+
+            bool frameDue = game_task_due(&render, now);
+            if (frameDue && game_update_is_clearing()) {
+                if (game_update_advance_clear()) {
+                    piece = init_falling_piece();
+                    game_input_piece_spawned(&input);
+                }
+            }
+
+            if (game_task_due(&poll, now) && !game_update_is_clearing()) {
+                remote_get_x_y_status(&pitch, &roll);
+                if (game_input_swap(&input, pitch == X_SWAP)) swap(&piece);
+
+                int dir = (roll == LEFT) ? -1 : (roll == RIGHT) ? 1 : 0;
+                for (int moves = game_input_shift(&input, dir, now); moves > 0; moves--) {
+                    if (dir < 0) move_left(&piece);
+                    else move_right(&piece);
+                }
+
+                while (remote_is_button_press()) rotate(&piece);
+
+                int rows = game_input_soft_drop(&input, pitch == X_FAST, now);
+                if (rows > 0) move_down_by(&piece, rows);
+
+                if (game_input_lock_due(&input, game_update_has_fallen(&piece), now)) {
+                    iterateThroughPieceSquares(&piece, update_background);
+                    clearRows();
+                    if (!game_update_is_clearing()) {
+                        piece = init_falling_piece();
+                        game_input_piece_spawned(&input);
+                    }
+                }
+            }
+
+            for (int ticks = game_task_due(&gravity, now); ticks > 0; ticks--) {
+                if (!game_update_is_clearing()) move_down(&piece);
+            }
+            game_task_set_period(&gravity, game_engine_gravity_us(&game_engine_default_gravity, game_update_get_rows_cleared()));
+
+            // frame time: one frame drawn and swapped
+            if (frameDue) {
+                unsigned long frameStart = timer_get_ticks();
+                unsigned long cyclesStart = game_scheduler_cycles();
+                if (game_update_render()) {
+                    unsigned long cycles = game_scheduler_cycles() - cyclesStart;
+                    unsigned long usec = (timer_get_ticks() - frameStart) / TICKS_PER_USEC;
+                    frames++;
+                    frameUsTotal += usec;
+                    frameCycles += cycles;
+                    if (usec > frameUsMax) frameUsMax = usec;
+                    if (cycles > frameCyclesMax) frameCyclesMax = cycles;
+                    frameBuckets[(usec / FRAME_BUCKET_US < FRAME_BUCKETS) ? usec / FRAME_BUCKET_US : FRAME_BUCKETS - 1]++;
+                }
+            }
+
+            game_events_dispatch();
+        }
+        game_update_set_deferred_render(false);
+        const replay_t* replay = game_update_get_replay();
+        printf("game %d: seed %d, %s, %d pieces, %d lines, score %d, replay hash %x; %ld frames (%ld dropped), %ld polls\n",
+               games, SCRIPT_SEED + games, game_update_is_game_over() ? "game over" : "script done", replay->pieces,
+               replay->lines, replay->score, replay->hash, render.runs, render.dropped, poll.runs);
+    }
+    unsigned long totalCycles = game_scheduler_cycles() - startCycles;
+    unsigned long totalUs = (timer_get_ticks() - startTicks) / TICKS_PER_USEC;
+    remote_script_start(NULL, 0);
+
+    // percentiles from the histogram (bucket upper bounds)
+    unsigned long percentiles[3] = {50, 95, 99};
+    unsigned long bounds[3] = {0, 0, 0};
+    for (int p = 0; p < 3; p++) {
+        unsigned long seen = 0;
+        for (int b = 0; b < FRAME_BUCKETS && bounds[p] == 0; b++) {
+            seen += frameBuckets[b];
+            if (100 * seen >= percentiles[p] * frames) bounds[p] = (b + 1) * FRAME_BUCKET_US;
+        }
+    }
+    printf("scripted run: %ld usec, %ld total cycles, %ld loop iterations\n", totalUs, totalCycles, iterations);
+    printf("frames: %ld rendered, frame time avg %ld usec (%ld cycles), p50 <= %ld, p95 <= %ld, p99 <= %ld, max %ld usec (%ld cycles)\n",
+           frames, frameUsTotal / (frames ? frames : 1), frameCycles / (frames ? frames : 1), bounds[0], bounds[1],
+           bounds[2], frameUsMax, frameCyclesMax);
+}
+
+// simple LCG for tests (no rand() in libmango)
+static unsigned int test_seed = 107;
+static unsigned int test_rand(void) {
+    test_seed = test_seed * 1103515245 + 12345;
+    return (test_seed >> 16) & 0x7FFF;
+}
+
+// fills the bottom two thirds of the board with random squares (denser toward the bottom)
+static void fill_random_board(int nrows, int ncols) {
+    falling_piece_t filler;
+    filler.pieceT = pieces[test_rand() % 7];
+    for (int y = nrows / 3; y < nrows; y++) {
+        for (int x = 0; x < ncols; x++) {
+            if ((int)(test_rand() % nrows) < y) update_background(x, y, &filler);
+        }
+    }
+}
+
+// differential test: bitboard collision engine vs. grid checks over the precomputed piece geometry 
+// (and vs. the original per-square checkIfFallen callback for fallen checks)
+// checks every piece, rotation and (x, y) position (including out of bounds ones) on a handful of random boards
+void test_bitboard_collision(void) {
+    timer_init();
+    uart_init();
+    int nrows = 20; int ncols = 10;
+    int checks = 0; int mismatches = 0;
+
+    for (int board = 0; board < 8; board++) {
+        game_update_init(nrows, ncols);
+        fill_random_board(nrows, ncols);
+
+        falling_piece_t piece;
+        for (int p = 0; p < 7; p++) {
+            piece.pieceT = pieces[p];
+            for (int r = 0; r < 4; r++) {
+                piece.rotation = r;
+                for (int y = -3; y <= nrows; y++) {
+                    for (int x = -5; x <= ncols + 1; x++) {
+                        piece.x = x; piece.y = y;
+
+                        game_update_set_bitboard_mode(false);
+                        bool gridValid = game_update_is_valid_position(&piece);
+                        game_update_set_bitboard_mode(true);
+                        bool fastValid = game_update_is_valid_position(&piece);
+                        checks++;
+                        if (gridValid != fastValid) {
+                            if (mismatches++ < 10) printf("valid mismatch: piece %c rot %d (%d, %d) grid=%d bitboard=%d\n", piece.pieceT.name, r, x, y, gridValid, fastValid);
+                        }
+                        if (!gridValid) continue;
+
+                        // fallen check is only defined for valid positions
+                        piece.fallen = false;
+                        bool callbackFallen = iterateVariant(&piece, checkIfFallen);
+                        piece.fallen = false;
+                        game_update_set_bitboard_mode(false);
+                        bool gridFallen = game_update_has_fallen(&piece);
+                        piece.fallen = false;
+                        game_update_set_bitboard_mode(true);
+                        bool fastFallen = game_update_has_fallen(&piece);
+                        checks++;
+                        if (callbackFallen != gridFallen || gridFallen != fastFallen || piece.fallen != fastFallen) {
+                            if (mismatches++ < 10) printf("fallen mismatch: piece %c rot %d (%d, %d) callback=%d grid=%d bitboard=%d\n", piece.pieceT.name, r, x, y, callbackFallen, gridFallen, fastFallen);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    printf("\nbitboard differential test: %d checks, %d mismatches\n", checks, mismatches);
+    assert(mismatches == 0);
+}
+
+// benchmark: collision tests per second for the grid checks vs. the bitboard, on a random mid-game board
+void test_bitboard_benchmark(void) {
+    timer_init();
+    uart_init();
+    int nrows = 20; int ncols = 10;
+    const int trials = 200000;
+    game_update_init(nrows, ncols);
+    fill_random_board(nrows, ncols);
+
+    for (int mode = 0; mode < 2; mode++) {
+        game_update_set_bitboard_mode(mode == 1);
+        falling_piece_t piece;
+        piece.fallen = false;
+        int valid = 0;
+        unsigned long start = timer_get_ticks();
+        for (int n = 0; n < trials; n++) {
+            piece.pieceT = pieces[n % 7];
+            piece.rotation = n % 4;
+            piece.x = n % ncols - 1;
+            piece.y = n % nrows;
+            valid += game_update_is_valid_position(&piece);
+        }
+        unsigned long ticks = timer_get_ticks() - start;
+        printf("%s: %d collision tests (%d valid) in %ld usec -> %ld tests/sec\n", (mode == 1) ? "bitboard" : "grid",
+               trials, valid, ticks / TICKS_PER_USEC, (long)trials * TICKS_PER_USEC * 1000000 / (long)ticks);
+    }
+}
+
+// line clear test: locks an i piece that completes 2 of the bottom 4 rows, then checks that the clear animation
+// runs without blocking, the rows above drop in one pass and the score is 100
+void test_clear_rows(void) {
+    timer_init();
+    uart_init();
+    int nrows = 20; int ncols = 10;
+    game_update_init(nrows, ncols);
+
+    // rows 16-19 filled except column 0; rows 16 and 18 also have a gap in column 5
+    falling_piece_t filler;
+    filler.pieceT = pieces[3];
+    for (int y = 16; y < nrows; y++) {
+        for (int x = 1; x < ncols; x++) {
+            if (!(x == 5 && (y == 16 || y == 18))) update_background(x, y, &filler);
+        }
+    }
+    // vertical i piece (rotation 1 has its squares in grid column 2) dropped into column 0
+    falling_piece_t piece;
+    piece.pieceT = pieces[0];
+    piece.rotation = 1;
+    piece.x = -2; piece.y = 16;
+    piece.fallen = false;
+    assert(game_update_is_valid_position(&piece));
+    iterateThroughPieceSquares(&piece, update_background);
+
+    // before: clearRows vibrated and sped up the music inline, for every row cleared; time that for one row
+    int tempo = buzzer_intr_get_tempo();
+    unsigned long oldStart = timer_get_ticks();
+    remote_vibrate(2);
+    buzzer_intr_set_tempo(buzzer_intr_get_tempo() + 2);
+    unsigned long oldStallPerRow = (timer_get_ticks() - oldStart) / TICKS_PER_USEC;
+    buzzer_intr_set_tempo(tempo);
+
+    unsigned long start = timer_get_ticks();
+    clearRows();
+    unsigned long stall = (timer_get_ticks() - start) / TICKS_PER_USEC;
+    unsigned long dispatchStart = timer_get_ticks();
+    int dispatched = game_events_dispatch();    // vibration and music, as the game loop runs them
+    unsigned long dispatchTime = (timer_get_ticks() - dispatchStart) / TICKS_PER_USEC;
+    printf("clearRows returned after %ld usec, %d events dispatched in %ld usec\n", stall, dispatched, dispatchTime);
+    printf("loop stall for this 2-row clear: before %ld usec (%ld per row), after %ld usec\n", 2 * oldStallPerRow,
+           oldStallPerRow, stall + dispatchTime);
+    assert(dispatched == 2);
+    assert(stall + dispatchTime < 100000);
+    assert(game_update_is_clearing());
+    int iterations = 0;
+    while (!game_update_advance_clear()) iterations++;
+    printf("clear animation finished after %ld usec (%d game loop iterations)\n", (timer_get_ticks() - start) / TICKS_PER_USEC, iterations);
+
+    assert(!game_update_is_clearing());
+    assert(game_update_get_score() == 100);
+    assert(game_update_get_rows_cleared() == 2);
+    // old rows 16 and 18 (gap in column 5) now sit in rows 18 and 19; everything above is empty
+    for (int y = 0; y < nrows; y++) {
+        for (int x = 0; x < ncols; x++) {
+            bool expected = (y >= 18) && (x != 5);
+            assert(game_update_is_filled(x, y) == expected);
+        }
+    }
+    printf("line clear test passed\n");
+}
+
+// differential test: ring board storage vs. a plain grid where clearing a row shifts every row above it
+// random fills and row removals (anywhere on the board, so both sides of the ring get exercised)
+void test_board_ring(void) {
+    timer_init();
+    uart_init();
+    int nrows = 20; int ncols = 10;
+    board_t board;
+    board_init(&board, nrows, ncols);
+    unsigned char grid[20][10];
+    memset(grid, 0, sizeof(grid));
+
+    int mismatches = 0;
+    for (int step = 0; step < 20000; step++) {
+        int x = test_rand() % ncols; int y = test_rand() % nrows;
+        if (test_rand() % 4 != 0) {
+            int square = 1 + test_rand() % 7;
+            board_set_square(&board, x, y, square);
+            grid[y][x] = square;
+        } else if (test_rand() % 2 == 0) {
+            board_remove_row(&board, y);
+            for (int destRow = y; destRow > 0; destRow--) memcpy(grid[destRow], grid[destRow - 1], sizeof(grid[0]));
+            memset(grid[0], 0, sizeof(grid[0]));
+        } else {
+            board_empty_row(&board, y);
+            memset(grid[y], 0, sizeof(grid[0]));
+        }
+        for (int row = 0; row < nrows; row++) {
+            bool filled = true;
+            for (int col = 0; col < ncols; col++) {
+                if (board_get_square(&board, col, row) != grid[row][col]) mismatches++;
+                if (grid[row][col] == 0) filled = false;
+            }
+            if (board_is_row_filled(&board, row) != filled) mismatches++;
+        }
+        for (int col = 0; col < ncols; col++) {
+            int top = 0;
+            while (top < nrows && grid[top][col] == 0) top++;
+            if (board_column_top(&board, col) != top) mismatches++;
+        }
+    }
+    board_free(&board);
+    printf("\nboard ring differential test: %d mismatches\n", mismatches);
+    assert(mismatches == 0);
+}
+
+// benchmark: cost of clearing the bottom line and a middle line of 20-, 200- and 2000-row boards with the ring
+// storage vs. the old layout that copied every row above the cleared one down by one
+void test_board_clear_benchmark(void) {
+    timer_init();
+    uart_init();
+#ifdef STATIC_BOARD
+    printf("\nskipped: needs boards of several sizes (STATIC_BOARD build)\n");
+    return;
+#endif
+    const int heights[3] = {20, 200, 2000};
+    int ncols = 10;
+    const int clears = 1000;
+
+    for (int h = 0; h < 3; h++) {
+        int nrows = heights[h];
+        // clearing the bottom row moves no row indices; the middle row is the worst case, moving nrows / 2 of them
+        // (the rows under it are filled, as in a game, so the cleared columns' heights don't rescan empty rows)
+        unsigned long ringTicks[2];
+        for (int mid = 0; mid < 2; mid++) {
+            int y = mid ? nrows / 2 : nrows - 1;
+            board_t board;
+            board_init(&board, nrows, ncols);
+            for (int row = y + 1; row < nrows; row++) {
+                for (int x = 0; x < ncols; x++) board_set_square(&board, x, row, 1);
+            }
+            unsigned long start = timer_get_ticks();
+            for (int n = 0; n < clears; n++) {
+                for (int x = 0; x < ncols; x++) board_set_square(&board, x, y, 1);
+                board_remove_row(&board, y);
+            }
+            ringTicks[mid] = timer_get_ticks() - start;
+            board_free(&board);
+        }
+
+        color_t* squares = malloc(nrows * ncols * sizeof(color_t));
+        memset(squares, 0, nrows * ncols * sizeof(color_t));
+        color_t (*background)[ncols] = (color_t (*)[ncols])squares;
+        unsigned long start = timer_get_ticks();
+        for (int n = 0; n < clears; n++) {
+            for (int x = 0; x < ncols; x++) background[nrows - 1][x] = GL_RED;
+            for (int destRow = nrows - 1; destRow > 0; destRow--) {
+                for (int col = 0; col < ncols; col++) background[destRow][col] = background[destRow - 1][col];
+            }
+            memset(background, 0, ncols * sizeof(color_t));
+        }
+        unsigned long shiftTicks = timer_get_ticks() - start;
+        free(squares);
+
+        printf("%d rows: ring %ld ns/clear (bottom row), %ld ns/clear (middle row), row shifting %ld ns/clear\n", nrows,
+               ringTicks[0] * 1000 / TICKS_PER_USEC / clears, ringTicks[1] * 1000 / TICKS_PER_USEC / clears,
+               shiftTicks * 1000 / TICKS_PER_USEC / clears);
+    }
+}
+
+// Landing row from column heights + bottom profile vs. stepping the piece down one row at a time
+void test_landing_row(void) {
+    timer_init();
+    uart_init();
+    int nrows = 20; int ncols = 10;
+    int checks = 0; int mismatches = 0;
+
+    for (int board = 0; board < 8; board++) {
+        game_update_init(nrows, ncols);
+        fill_random_board(nrows, ncols);
+
+        falling_piece_t piece;
+        for (int p = 0; p < 7; p++) {
+            piece.pieceT = pieces[p];
+            for (int r = 0; r < 4; r++) {
+                piece.rotation = r;
+                for (int y = -3; y < nrows; y++) {
+                    for (int x = -3; x < ncols; x++) {
+                        piece.x = x; piece.y = y;
+                        if (!game_update_is_valid_position(&piece)) continue;
+
+                        falling_piece_t probe = piece;
+                        while (game_update_is_valid_position(&probe)) probe.y++;
+                        int landing = game_update_get_landing_row(&piece);
+                        checks++;
+                        if (landing != probe.y - 1) {
+                            if (mismatches++ < 10) printf("landing mismatch: piece %c rot %d (%d, %d) heights=%d stepped=%d\n", piece.pieceT.name, r, x, y, landing, probe.y - 1);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    printf("\nlanding row test: %d checks, %d mismatches\n", checks, mismatches);
+    assert(mismatches == 0);
+}
+
+// Headless engine: games with the same seed and inputs stay identical even when other games are stepped in between,
+// and the engine keeps running with no gl/timer involvement
+void test_game_engine(void) {
+    timer_init();
+    uart_init();
+    game_state_t a, b, other;
+    game_engine_init(&a, 20, 10, 107);
+    game_engine_init(&b, 20, 10, 107);
+    game_engine_init(&other, 20, 10, 42);
+    game_engine_spawn(&a); game_engine_spawn(&b); game_engine_spawn(&other);
+
+    game_input_t inputs[] = {INPUT_LEFT, INPUT_RIGHT, INPUT_ROTATE, INPUT_DOWN, INPUT_DOWN, INPUT_HARD_DROP, INPUT_SWAP};
+    int ninputs = sizeof(inputs) / sizeof(inputs[0]);
+    int mismatches = 0; int locks = 0; int games = 1;
+    unsigned long start = timer_get_ticks();
+    int steps;
+    for (steps = 0; steps < 20000; steps++) {
+        game_input_t input = inputs[test_rand() % ninputs];
+        int eventsA = game_engine_step(&a, input);
+        game_engine_step(&other, inputs[test_rand() % ninputs]);
+        int eventsB = game_engine_step(&b, input);
+        if (eventsA & EVENT_LOCKED) locks++;
+        if (eventsA != eventsB || a.piece.x != b.piece.x || a.piece.y != b.piece.y || a.piece.pieceT.id != b.piece.pieceT.id
+            || a.score != b.score || a.linesCleared != b.linesCleared) mismatches++;
+        for (int y = 0; y < 20; y++) {
+            for (int x = 0; x < 10; x++) {
+                if (board_get_square(&a.board, x, y) != board_get_square(&b.board, x, y)) mismatches++;
+            }
+        }
+        if (a.gameOver) {
+            // both games restart from the same new seed
+            game_engine_free(&a); game_engine_free(&b);
+            game_engine_init(&a, 20, 10, steps);
+            game_engine_init(&b, 20, 10, steps);
+            game_engine_spawn(&a); game_engine_spawn(&b);
+            games++;
+        }
+    }
+    unsigned long usecs = (timer_get_ticks() - start) / TICKS_PER_USEC;
+    printf("\ngame engine: %d steps (x3 games) in %ld usec, %d games, %d pieces locked, %d mismatches\n", steps, usecs, games, locks, mismatches);
+    game_engine_free(&a); game_engine_free(&b); game_engine_free(&other);
+    assert(mismatches == 0);
+    assert(locks > 0);
+}
+
+// Helper to checksum a board's squares
+static unsigned int board_checksum(const board_t* board) {
+    unsigned int sum = 0;
+    for (int y = 0; y < board->nrows; y++) {
+        for (int x = 0; x < board->ncols; x++) sum = sum * 31 + board_get_square(board, x, y);
+    }
+    return sum;
+}
+
+// Snapshots: restoring and replaying the same inputs reproduces the game exactly, and a snapshot's (shared) board
+// is unaffected by the game changing its board afterwards
+void test_snapshots(void) {
+    timer_init();
+    uart_init();
+    printf("\nsizeof(falling_piece_t) = %d, sizeof(packed_piece_t) = %d, sizeof(game_snapshot_t) = %d\n",
+           (int)sizeof(falling_piece_t), (int)sizeof(packed_piece_t), (int)sizeof(game_snapshot_t));
+    assert(sizeof(packed_piece_t) == 4);
+
+    game_input_t inputs[] = {INPUT_LEFT, INPUT_RIGHT, INPUT_ROTATE, INPUT_DOWN, INPUT_DOWN, INPUT_DOWN, INPUT_SWAP};
+    int ninputs = sizeof(inputs) / sizeof(inputs[0]);
+    game_input_t played[400];
+    game_state_t game;
+    game_snapshot_t snapshot;
+    int mismatches = 0;
+
+    for (int round = 0; round < 20; round++) {
+        game_engine_init(&game, 20, 10, round);
+        game_engine_spawn(&game);
+        for (int step = 0; step < 100 * round && !game.gameOver; step++) game_engine_step(&game, inputs[test_rand() % ninputs]);
+
+        game_engine_save(&game, &snapshot);
+        unsigned int savedSum = board_checksum(&snapshot.board);
+        for (int step = 0; step < 400; step++) {
+            played[step] = inputs[test_rand() % ninputs];
+            game_engine_step(&game, played[step]);
+        }
+        unsigned int endSum = board_checksum(&game.board);
+        falling_piece_t endPiece = game.piece;
+        int endScore = game.score;
+        if (board_checksum(&snapshot.board) != savedSum) mismatches++;
+
+        // replay twice from the same snapshot
+        for (int replay = 0; replay < 2; replay++) {
+            game_engine_restore(&game, &snapshot);
+            if (board_checksum(&game.board) != savedSum) mismatches++;
+            for (int step = 0; step < 400; step++) game_engine_step(&game, played[step]);
+            if (board_checksum(&game.board) != endSum || game.score != endScore || game.piece.x != endPiece.x
+                || game.piece.y != endPiece.y || game.piece.rotation != endPiece.rotation
+                || game.piece.pieceT.id != endPiece.pieceT.id) mismatches++;
+        }
+        game_engine_release_snapshot(&snapshot);
+        game_engine_free(&game);
+    }
+
+    // save/restore cost: neither copies the board
+    game_engine_init(&game, 20, 10, 107);
+    game_engine_spawn(&game);
+    unsigned long start = timer_get_ticks();
+    for (int k = 0; k < 10000; k++) {
+        game_engine_save(&game, &snapshot);
+        game_engine_restore(&game, &snapshot);
+        game_engine_release_snapshot(&snapshot);
+    }
+    unsigned long usecs = (timer_get_ticks() - start) / TICKS_PER_USEC;
+    game_engine_free(&game);
+    printf("snapshot test: %d mismatches, save + restore %ld nsec\n", mismatches, usecs * 1000 / 10000);
+    assert(mismatches == 0);
+}
+
+// Palette-indexed (4-bit) board squares vs. the old color_t per square: memory, row-full checks, row copies and
+// resolving every square to a color as draw_background does
+void test_board_cells_benchmark(void) {
+    timer_init();
+    uart_init();
+#ifdef STATIC_BOARD
+    printf("\nskipped: needs boards of several sizes (STATIC_BOARD build)\n");
+    return;
+#endif
+    const int sizes[3][2] = {{20, 10}, {200, 100}, {2000, 200}};   // nrows, ncols; the wider boards have no bitboard
+    const int reps = 20;
+
+    for (int n = 0; n < 3; n++) {
+        int nrows = sizes[n][0]; int ncols = sizes[n][1];
+        board_t board;
+        board_init(&board, nrows, ncols);
+        color_t* colors = malloc(nrows * ncols * sizeof(color_t));
+        memset(colors, 0, nrows * ncols * sizeof(color_t));
+        // mostly filled rows, with the gap (if any) near the end of the row so the scans go deep
+        for (int y = 0; y < nrows; y++) {
+            for (int x = 0; x < ncols; x++) {
+                if (x == ncols - 1 && y % 2) continue;
+                int square = 1 + test_rand() % 7;
+                board_set_square(&board, x, y, square);
+                colors[y * ncols + x] = tetromino_set.palette[square];
+            }
+        }
+
+        int filledPacked = 0; int filledColors = 0;
+        unsigned long start = timer_get_ticks();
+        for (int r = 0; r < reps; r++) {
+            for (int y = 0; y < nrows; y++) filledPacked += board_is_row_filled(&board, y);
+        }
+        unsigned long packedFullTicks = timer_get_ticks() - start;
+        start = timer_get_ticks();
+        for (int r = 0; r < reps; r++) {
+            for (int y = 0; y < nrows; y++) {
+                bool filled = true;
+                for (int x = 0; x < ncols && filled; x++) filled = colors[y * ncols + x] != 0;
+                filledColors += filled;
+            }
+        }
+        unsigned long colorFullTicks = timer_get_ticks() - start;
+        assert(filledPacked == filledColors);
+
+        start = timer_get_ticks();
+        for (int r = 0; r < reps; r++) {
+            for (int y = nrows - 1; y > 0; y--) memcpy(board_row(&board, y), board_row(&board, y - 1), board.rowBytes);
+        }
+        unsigned long packedCopyTicks = timer_get_ticks() - start;
+        start = timer_get_ticks();
+        for (int r = 0; r < reps; r++) {
+            for (int y = nrows - 1; y > 0; y--) memcpy(colors + y * ncols, colors + (y - 1) * ncols, ncols * sizeof(color_t));
+        }
+        unsigned long colorCopyTicks = timer_get_ticks() - start;
+
+        unsigned int sumPacked = 0; unsigned int sumColors = 0;
+        start = timer_get_ticks();
+        for (int r = 0; r < reps; r++) {
+            for (int y = 0; y < nrows; y++) {
+                // pair at a time, as in draw_background
+                const unsigned char* row = board_row(&board, y);
+                for (int pair = 0; pair < board.rowBytes; pair++) {
+                    if (row[pair] == 0) continue;
+                    if (row[pair] & 0x0F) sumPacked += tetromino_set.palette[row[pair] & 0x0F];
+                    if (row[pair] >> 4) sumPacked += tetromino_set.palette[row[pair] >> 4];
+                }
+            }
+        }
+        unsigned long packedDrawTicks = timer_get_ticks() - start;
+        start = timer_get_ticks();
+        for (int r = 0; r < reps; r++) {
+            for (int y = 0; y < nrows * ncols; y++) {
+                if (colors[y] != 0) sumColors += colors[y];
+            }
+        }
+        unsigned long colorDrawTicks = timer_get_ticks() - start;
+        assert(sumPacked == sumColors);
+
+        printf("\n%d x %d board: squares %d bytes (color_t: %d bytes)\n", nrows, ncols, nrows * board.rowBytes, nrows * ncols * (int)sizeof(color_t));
+        printf("  row-full checks %ld usec (color_t: %ld), row copies %ld usec (color_t: %ld), palette lookups %ld usec (color_t: %ld)\n",
+               packedFullTicks / TICKS_PER_USEC, colorFullTicks / TICKS_PER_USEC, packedCopyTicks / TICKS_PER_USEC,
+               colorCopyTicks / TICKS_PER_USEC, packedDrawTicks / TICKS_PER_USEC, colorDrawTicks / TICKS_PER_USEC);
+        free(colors);
+        board_free(&board);
+    }
+}
+
+// Cost of a move in the engine (no drawing): compare a STATIC_BOARD build against the default (dynamic) build
+void test_move_cost(void) {
+    timer_init();
+    uart_init();
+    game_state_t game;
+    game_engine_init(&game, 20, 10, 107);
+    game_engine_spawn(&game);
+    const int moves = 100000;
+    int made = 0;
+
+    unsigned long start = timer_get_ticks();
+    for (int n = 0; n < moves; n++) {
+        // walk the piece left and right across the board, rotating and dropping now and then
+        switch (n & 7) {
+            case 0: case 1: case 2: made += game_engine_move(&game, &game.piece, -1, 0); break;
+            case 3: case 4: case 5: made += game_engine_move(&game, &game.piece, 1, 0); break;
+            case 6: made += game_engine_rotate(&game, &game.piece); break;
+            case 7:
+                if (!game_engine_move(&game, &game.piece, 0, 1)) {
+                    game_engine_lock(&game, &game.piece);
+                    if (!game_engine_spawn(&game)) {
+                        game_engine_free(&game);
+                        game_engine_init(&game, 20, 10, n);
+                        game_engine_spawn(&game);
+                    }
+                } else made++;
+                break;
+        }
+    }
+    unsigned long ticks = timer_get_ticks() - start;
+    game_engine_free(&game);
+#ifdef STATIC_BOARD
+    const char* build = "static";
+#else
+    const char* build = "dynamic";
+#endif
+    printf("\n%s board build: %d moves (%d made) in %ld usec, %ld ns/move\n", build, moves, made,
+           ticks / TICKS_PER_USEC, ticks * 1000 / TICKS_PER_USEC / moves);
+}
+
+// piece set test: for each set, grid vs bitboard collision checks agree for every piece/rotation/position,
+// headless games run to completion, and the bag deals every piece of the set equally often
+void test_piece_sets(void) {
+    timer_init();
+    uart_init();
+    const piece_set_t* sets[] = {&tetromino_set, &pentomino_set};
+    int nrows = 20; int ncols = 10;
+
+    for (int which = 0; which < 2; which++) {
+        const piece_set_t* set = sets[which];
+        game_state_t game;
+        game_engine_init_with_set(&game, set, nrows, ncols, 107);
+        for (int y = 6; y < nrows; y++) {
+            for (int x = 0; x < ncols; x++) {
+                if (test_rand() % 3 == 0) game_engine_set_square(&game, x, y, 1 + test_rand() % set->npieces % 15);
+            }
+        }
+
+        // grid vs bitboard
+        int checks = 0; int mismatches = 0;
+        falling_piece_t piece;
+        for (int p = 0; p < set->npieces; p++) {
+            piece.pieceT = set->pieces[p];
+            for (int r = 0; r < 4; r++) {
+                piece.rotation = r;
+                for (int y = -PIECE_GRID; y <= nrows; y++) {
+                    for (int x = -PIECE_GRID - 1; x <= ncols + 1; x++) {
+                        piece.x = x; piece.y = y;
+                        game_engine_set_bitboard_mode(&game, false);
+                        bool gridValid = game_engine_is_valid_position(&game, &piece);
+                        game_engine_set_bitboard_mode(&game, true);
+                        bool fastValid = game_engine_is_valid_position(&game, &piece);
+                        if (gridValid != fastValid) mismatches++;
+                        checks++;
+                    }
+                }
+            }
+        }
+        game_engine_free(&game);
+
+        // headless games with random inputs
+        game_input_t inputs[] = {INPUT_LEFT, INPUT_RIGHT, INPUT_ROTATE, INPUT_DOWN, INPUT_HARD_DROP, INPUT_SWAP};
+        int ninputs = sizeof(inputs) / sizeof(inputs[0]);
+        int locks = 0; int games = 1;
+        game_engine_init_with_set(&game, set, nrows, ncols, 107);
+        game_engine_spawn(&game);
+        for (int step = 0; step < 20000; step++) {
+            if (game_engine_step(&game, inputs[test_rand() % ninputs]) & EVENT_LOCKED) locks++;
+            if (game.gameOver) {
+                game_engine_free(&game);
+                game_engine_init_with_set(&game, set, nrows, ncols, step);
+                game_engine_spawn(&game);
+                games++;
+            }
+        }
+        game_engine_free(&game);
+
+        // bag fairness: after whole bags, every piece has been dealt the same number of times
+        random_bag_t bag;
+        random_bag_init_seeded(&bag, 107, set->npieces);
+        int dealt[PIECE_SET_MAX] = {0};
+        int bagSize = bag.size;
+        for (int n = 0; n < bagSize * 10; n++) dealt[random_bag_choose_from(&bag)]++;
+        int unfair = 0;
+        for (int p = 0; p < set->npieces; p++) {
+            if (dealt[p] != dealt[0]) unfair++;
+        }
+
+        printf("\n%s set: %d pieces, %d collision checks (%d mismatches), %d games, %d pieces locked, %d pieces dealt %d times each (%d unfair)\n",
+               set->name, set->npieces, checks, mismatches, games, locks, set->npieces, dealt[0], unfair);
+        assert(mismatches == 0);
+        assert(locks > 0);
+        assert(unfair == 0);
+    }
+}
+
+// piece queue test: the queue shows exactly the pieces that spawn next (in the order the bag deals them), swap
+// puts the falling piece at the front, and snapshots bring the queue back
+void test_piece_queue(void) {
+    timer_init();
+    uart_init();
+    game_state_t game;
+    random_bag_t bag;
+    game_engine_init(&game, 20, 10, 107);
+    random_bag_init_seeded(&bag, 107, tetromino_set.npieces);
+    int mismatches = 0;
+
+    // the queue holds the first PIECE_QUEUE_SIZE pieces the bag deals
+    for (int n = 0; n < PIECE_QUEUE_SIZE; n++) {
+        if (game_engine_peek(&game, n)->id != random_bag_choose_from(&bag)) mismatches++;
+    }
+    // every spawn takes the front of the queue and the queue moves up by one
+    for (int spawns = 0; spawns < 1000; spawns++) {
+        char ahead[PIECE_QUEUE_SIZE];
+        for (int n = 0; n < PIECE_QUEUE_SIZE; n++) ahead[n] = game_engine_peek(&game, n)->id;
+        if (!game_engine_spawn(&game)) {
+            game_engine_free(&game);
+            game_engine_init(&game, 20, 10, 107);
+            random_bag_init_seeded(&bag, 107, tetromino_set.npieces);
+            for (int n = 0; n < PIECE_QUEUE_SIZE; n++) random_bag_choose_from(&bag);
+            continue;
+        }
+        if (game.piece.pieceT.id != ahead[0]) mismatches++;
+        for (int n = 0; n < PIECE_QUEUE_SIZE - 1; n++) {
+            if (game_engine_peek(&game, n)->id != ahead[n + 1]) mismatches++;
+        }
+        if (game_engine_peek(&game, PIECE_QUEUE_SIZE - 1)->id != random_bag_choose_from(&bag)) mismatches++;
+        game_engine_move_down_by(&game, &game.piece, 20);
+        game_engine_lock(&game, &game.piece);
+    }
+
+    // swap and undo
+    game_snapshot_t snapshot;
+    game_engine_save(&game, &snapshot);
+    char falling = game.piece.pieceT.id; char next = game_engine_peek(&game, 0)->id;
+    if (game_engine_swap(&game, &game.piece)) {
+        if (game.piece.pieceT.id != next || game_engine_peek(&game, 0)->id != falling) mismatches++;
+    }
+    game_engine_restore(&game, &snapshot);
+    if (game.piece.pieceT.id != falling || game_engine_peek(&game, 0)->id != next) mismatches++;
+    game_engine_release_snapshot(&snapshot);
+
+    unsigned long start = timer_get_ticks();
+    int sum = 0;
+    for (int reads = 0; reads < 1000000; reads++) sum += game_engine_peek(&game, reads & (PIECE_QUEUE_SIZE - 1))->id;
+    unsigned long ticks = timer_get_ticks() - start;
+    game_engine_free(&game);
+    printf("\npiece queue test: %d mismatches, %ld ns per peek (checksum %d)\n", mismatches, ticks * 1000 / TICKS_PER_USEC / 1000000, sum);
+    assert(mismatches == 0);
+}
+
+// input timing test: holding a direction, soft drop and resting on the stack give the same moves and lock time
+// whether the game loop samples the inputs every 100 usec or every 15 ms
+void test_game_input(void) {
+    timer_init();
+    uart_init();
+    unsigned long periods[] = {100, 1000, 4000, 15000};
+    int mismatches = 0;
+    int shifts0 = 0; int drops0 = 0; unsigned long lock0 = 0;
+
+    for (int p = 0; p < 4; p++) {
+        input_state_t input;
+        game_input_init(&input, &game_input_default_timing);
+        int shifts = 0; int drops = 0; unsigned long lockedAt = 0;
+        // hold right for the first second, then soft drop for half a second, then rest on the stack
+        for (unsigned long now = 0; now <= 3000000; now += periods[p]) {
+            shifts += game_input_shift(&input, (now < 1000000) ? 1 : 0, now);
+            drops += game_input_soft_drop(&input, now >= 1200000 && now < 1700000, now);
+            if (game_input_lock_due(&input, now >= 2000000, now) && lockedAt == 0) lockedAt = now;
+        }
+        if (p == 0) {
+            shifts0 = shifts; drops0 = drops; lock0 = lockedAt;
+        } else {
+            if (shifts != shifts0 || drops != drops0) mismatches++;
+            // a lock can only be seen at a sample, so it's up to one period late
+            if (lockedAt < lock0 || lockedAt > lock0 + periods[p]) mismatches++;
+        }
+        printf("\nloop every %ld usec: %d shifts, %d rows soft dropped, locked at %ld usec", periods[p], shifts, drops, lockedAt);
+    }
+    printf("\ninput timing test: %d mismatches\n", mismatches);
+    assert(mismatches == 0);
+    assert(lock0 == 2000000 + game_input_default_timing.lockDelayUs);
+}
 
+// scheduler test: a task ticks on its own fixed timestep through loop stalls -- every tick is either run (on time,
+// or caught up late) or counted as dropped, and ticks stay in phase; plus the gravity curve speeds up by level
+void test_game_scheduler(void) {
+    timer_init();
+    uart_init();
+    int mismatches = 0;
+    game_task_t task;
+    game_task_init(&task, 1000, 3, 0);
+    unsigned long now = 0;
+    for (int iter = 0; iter < 100000; iter++) {
+        // mostly short iterations, with the occasional stall of up to 10 periods
+        now += (test_rand() % 50 == 0) ? test_rand() % 10000 : test_rand() % 300;
+        int ticks = game_task_due(&task, now);
+        if (ticks > task.maxCatchUp) mismatches++;
+        if (task.nextUs <= now || task.nextUs > now + task.periodUs || task.nextUs % task.periodUs != 0) mismatches++;
+    }
+    if (task.runs + task.dropped != now / task.periodUs) mismatches++;
+    printf("\nscheduler test: %ld ticks due over %ld usec: %ld run (%ld of them late), %ld dropped, %d mismatches\n",
+           now / task.periodUs, now, task.runs, task.late, task.dropped, mismatches);
+
+    // changing the period moves the next tick to one new period after the last one
+    game_task_init(&task, 480000, 2, 0);
+    game_task_due(&task, 500000);
+    game_task_set_period(&task, 430000);
+    if (task.nextUs != 480000 + 430000) mismatches++;
+
+    unsigned long previous = game_engine_gravity_us(&game_engine_default_gravity, 0);
+    if (previous != 480000) mismatches++;
+    for (int lines = 0; lines < 300; lines += 10) {
+        unsigned long period = game_engine_gravity_us(&game_engine_default_gravity, lines);
+        if (period > previous) mismatches++;
+        previous = period;
+    }
+    printf("gravity: %ld usec at 0 lines, %ld usec at 50, %ld usec from 140 on\n",
+           game_engine_gravity_us(&game_engine_default_gravity, 0), game_engine_gravity_us(&game_engine_default_gravity, 50), previous);
+    assert(mismatches == 0);
+}
 
+// fixed-point test: Q16.16 math and time conversions give the integer results the float code used to
+void test_fixed_point(void) {
+    timer_init();
+    uart_init();
+    int mismatches = 0;
+    unsigned long n = MSEC_TO_TICKS(480);
+    // 0.8 isn't exact in Q16.16: off by at most n / 2^16
+    if (fix16_scale(n, FIX16_CONST(0.8)) - MSEC_TO_TICKS(384) > (n >> FIX16_SHIFT)) mismatches++;
+    if (fix16_scale(1000, FIX16_CONST(0.25)) != 250) mismatches++;
+    if (fix16_to_int(fix16_mul(fix16_from_int(3), FIX16_CONST(1.5))) != 4) mismatches++;           // 4.5 -> 4
+    if (fix16_mul(fix16_from_int(-2), FIX16_CONST(0.5)) != fix16_from_int(-1)) mismatches++;
+    if (fix16_div(fix16_from_int(1), fix16_from_int(4)) != FIX16_CONST(0.25)) mismatches++;
+    if (fix16_to_int(fix16_div(fix16_from_int(480), FIX16_CONST(0.75))) != 640) mismatches++;
+    if (TICKS_TO_USEC(USEC_TO_TICKS(1234)) != 1234) mismatches++;
+
+    // the loop window check as the old game loops ran it, every spin
+    unsigned long start = timer_get_ticks();
+    int inWindow = 0;
+    for (unsigned long t = 0; t < 1000000; t++) inWindow += (t * 97) % n <= fix16_scale(n, FIX16_CONST(0.8));
+    unsigned long ticks = timer_get_ticks() - start;
+    printf("\nfixed point test: %d mismatches, window check %ld ns (%d in window)\n", mismatches,
+           TICKS_TO_USEC(ticks * 1000) / 1000000, inWindow);
+    assert(mismatches == 0);
+}
 
+// timer wheel test (driven by calling timer_wheel_tick directly, no interrupt): one-shot timers fire on the tick
+// they're due (including ones more than a turn of the wheel away; timers started here, between ticks, wait one
+// extra tick so they never fire early), periodic timers keep their period, cancelled
+// timers never fire, and starting/cancelling costs the same however many timers are running
+#define WHEEL_TEST_TIMERS 600
+static sw_timer_t wheel_timers[WHEEL_TEST_TIMERS];
+static unsigned long wheel_due[WHEEL_TEST_TIMERS];
+static unsigned long wheel_first[WHEEL_TEST_TIMERS];
+static unsigned long wheel_fired[WHEEL_TEST_TIMERS];
+static int wheel_late;
+
+static void count_fire(void *aux) {
+    int n = (int)(long)aux;
+    if (timer_wheel_ticks() != wheel_due[n]) wheel_late++;
+    wheel_fired[n]++;
+    if (wheel_timers[n].periodTicks) wheel_due[n] += wheel_timers[n].periodTicks;
+}
 
+// callback that cancels timer 1 and restarts timer 2 five ticks later (both due on the same tick as it)
+static void cancel_others(void *aux) {
+    timer_wheel_cancel(&wheel_timers[1]);
+    timer_wheel_start(&wheel_timers[2], 5 * TIMER_WHEEL_TICK_US, 0, count_fire, (void *)2L);
+    count_fire(aux);
+}
 
+void test_timer_wheel(void) {
+    timer_init();
+    uart_init();
+    int mismatches = 0;
+    unsigned long start = timer_wheel_ticks();
+
+    // a third one-shot (up to ~3 turns of the wheel away), a third periodic, a third started then cancelled
+    unsigned long startTicks = timer_get_ticks();
+    for (int n = 0; n < WHEEL_TEST_TIMERS; n++) {
+        unsigned long delayTicks = 1 + test_rand() % (3 * TIMER_WHEEL_SLOTS);
+        unsigned long periodTicks = (n % 3 == 1) ? 1 + test_rand() % 50 : 0;
+        wheel_due[n] = wheel_first[n] = start + delayTicks + 1;
+        timer_wheel_start(&wheel_timers[n], delayTicks * TIMER_WHEEL_TICK_US, periodTicks * TIMER_WHEEL_TICK_US, count_fire, (void *)(long)n);
+    }
+    for (int n = 2; n < WHEEL_TEST_TIMERS; n += 3) timer_wheel_cancel(&wheel_timers[n]);
+    unsigned long opTicks = timer_get_ticks() - startTicks;
+
+    int ticks = 4 * TIMER_WHEEL_SLOTS;
+    for (int t = 0; t < ticks; t++) timer_wheel_tick();
+
+    for (int n = 0; n < WHEEL_TEST_TIMERS; n++) {
+        if (n % 3 == 0 && wheel_fired[n] != 1) mismatches++;
+        if (n % 3 == 1 && wheel_fired[n] != 1 + (start + ticks - wheel_first[n]) / wheel_timers[n].periodTicks) mismatches++;
+        if (n % 3 == 2 && wheel_fired[n] != 0) mismatches++;
+        if ((n % 3 == 1) != timer_wheel_is_active(&wheel_timers[n])) mismatches++;
+    }
+    for (int n = 1; n < WHEEL_TEST_TIMERS; n += 3) timer_wheel_cancel(&wheel_timers[n]);
+    printf("\ntimer wheel test: %d timers over %d ticks, %d fired late, %d mismatches, start/cancel %ld ns each\n",
+           WHEEL_TEST_TIMERS, ticks, wheel_late, mismatches, TICKS_TO_USEC(opTicks * 1000) / (WHEEL_TEST_TIMERS + WHEEL_TEST_TIMERS / 3));
+    assert(mismatches == 0 && wheel_late == 0);
+
+    // four timers in one slot: timer 3 (started last, so first in the slot's list) cancels timer 1 and restarts
+    // timer 2 from its callback, and timer 0 waits out a turn of the wheel behind them
+    start = timer_wheel_ticks();
+    for (int n = 0; n < 4; n++) {
+        wheel_fired[n] = 0;
+        wheel_due[n] = start + 11;
+    }
+    wheel_due[0] += TIMER_WHEEL_SLOTS;
+    wheel_due[2] += 5;
+    timer_wheel_start(&wheel_timers[0], (10 + TIMER_WHEEL_SLOTS) * TIMER_WHEEL_TICK_US, 0, count_fire, (void *)0L);
+    for (int n = 1; n < 3; n++) timer_wheel_start(&wheel_timers[n], 10 * TIMER_WHEEL_TICK_US, 0, count_fire, (void *)(long)n);
+    timer_wheel_start(&wheel_timers[3], 10 * TIMER_WHEEL_TICK_US, 0, cancel_others, (void *)3L);
+    for (int t = 0; t < 2 * TIMER_WHEEL_SLOTS; t++) timer_wheel_tick();
+    bool sameSlotOk = wheel_fired[0] == 1 && wheel_fired[1] == 0 && wheel_fired[2] == 1 && wheel_fired[3] == 1;
+    printf("timer wheel test: callback cancelling/restarting timers of its own slot %s, %d fired late\n",
+           sameSlotOk ? "ok" : "FAILED", wheel_late);
+    assert(sameSlotOk && wheel_late == 0);
+}
+
+static int eventLog[GAME_EVENT_QUEUE_SIZE * 2];
+static int eventLogged = 0;
+
+static void log_event(const game_event_t* event, void* aux) {
+    eventLog[eventLogged++] = (long)aux * 100 + event->type * 10 + event->count;
+}
+
+void test_game_events(void) {
+    timer_init();
+    uart_init();
+    game_events_reset();
+    assert(game_events_subscribe(GAME_EVENT_MASK(GAME_EVENT_LINES_CLEARED), log_event, (void *)1));
+    assert(game_events_subscribe(GAME_EVENT_MASK(GAME_EVENT_GAME_OVER), log_event, (void *)2));
+    // subscribing again replaces the mask rather than adding a second subscriber
+    assert(game_events_subscribe(GAME_EVENT_MASK(GAME_EVENT_LINES_CLEARED) | GAME_EVENT_MASK(GAME_EVENT_GAME_OVER), log_event, (void *)2));
+
+    // events reach only the subscribers of their type, in publishing order, then subscription order
+    assert(game_events_publish(GAME_EVENT_LOCKED, 0, 0));
+    assert(game_events_publish(GAME_EVENT_LINES_CLEARED, 3, 500));
+    assert(game_events_publish(GAME_EVENT_GAME_OVER, 0, 500));
+    assert(game_events_pending() == 3);
+    assert(game_events_dispatch() == 3 && game_events_pending() == 0);
+    assert(eventLogged == 3);
+    assert(eventLog[0] == 113 && eventLog[1] == 213 && eventLog[2] == 230);
+
+    // a full queue drops new events instead of blocking the publisher
+    eventLogged = 0;
+    for (int n = 0; n < GAME_EVENT_QUEUE_SIZE + 4; n++) {
+        assert(game_events_publish(GAME_EVENT_LINES_CLEARED, 1, 0) == (n < GAME_EVENT_QUEUE_SIZE));
+    }
+    assert(game_events_dropped() == 4);
+    assert(game_events_dispatch() == GAME_EVENT_QUEUE_SIZE && eventLogged == 2 * GAME_EVENT_QUEUE_SIZE);
+
+    game_events_reset();
+    printf("\ngame events test passed\n");
+}
+
+// moves in one frame are drawn once with deferred rendering, and each right away without it
+void test_frame_coalescing(void) {
+    timer_init();
+    uart_init();
+    game_update_init(20, 10);
+    game_update_set_seed(107);
+    falling_piece_t piece = init_falling_piece();
+    assert(game_update_get_frames_needed() == 1 && game_update_get_frames_rendered() == 1);
+
+    // immediate: one frame per change
+    move_left(&piece);
+    move_right(&piece);
+    rotate(&piece);
+    assert(game_update_get_frames_needed() == 4 && game_update_get_frames_rendered() == 4);
+
+    // deferred: a frame's worth of moves, one render
+    game_update_set_deferred_render(true);
+    unsigned long start = timer_get_ticks();
+    move_left(&piece);
+    rotate(&piece);
+    move_down_by(&piece, 2);
+    swap(&piece);
+    assert(game_update_get_frames_rendered() == 4);
+    assert(game_update_render());
+    assert(!game_update_render());      // nothing changed since
+    unsigned long usec = (timer_get_ticks() - start) / TICKS_PER_USEC;
+    assert(game_update_get_frames_needed() == 8 && game_update_get_frames_rendered() == 5);
+
+    // moves that don't happen don't ask for a frame
+    for (int n = 0; n < 20; n++) move_left(&piece);
+    assert(game_update_render());
+    assert(!game_update_render());
+    printf("\nframe coalescing test: %ld frames rendered for %ld needed (4 moves in one frame took %ld usec)\n",
+           game_update_get_frames_rendered(), game_update_get_frames_needed(), usec);
+    game_update_set_deferred_render(false);
+}
+
+// mid-game board: a bumpy stack 3 to 10 rows high with the odd hole, and an empty well column
+static void fill_midgame_board(game_state_t* game) {
+    int nrows = GAME_NROWS(game); int ncols = GAME_NCOLS(game);
+    int well = test_rand() % ncols;
+    int height = 3 + test_rand() % 8;
+    for (int x = 0; x < ncols; x++) {
+        height += (int)(test_rand() % 5) - 2;
+        if (height < 3) height = 3;
+        if (height > 10) height = 10;
+        if (x == well) continue;
+        for (int y = nrows - height; y < nrows; y++) {
+            if (test_rand() % 10 != 0) game_engine_set_square(game, x, y, 1 + test_rand() % 7);
+        }
+    }
+}
+
+// true if rotations r1 and r2 of piece at (x1, y1) and (x2, y2) cover the same board squares
+static bool same_squares(const piece_t* piece, int r1, int x1, int y1, int r2, int x2, int y2) {
+    const piece_geometry_t* a = &piece->geometry[r1];
+    const piece_geometry_t* b = &piece->geometry[r2];
+    if (a->ncells != b->ncells) return false;
+    for (int cell = 0; cell < a->ncells; cell++) {
+        if (x1 + a->cells[cell][0] != x2 + b->cells[cell][0] || y1 + a->cells[cell][1] != y2 + b->cells[cell][1]) return false;
+    }
+    return true;
+}
+
+#define REACH_ROWS (20 + PIECE_GRID - 1)
+#define REACH_COLS (10 + PIECE_GRID - 1)
+static bool reached[REACH_ROWS][REACH_COLS][4];
+
+// reference for placement_enumerate: marks reachable states by sweeping all of them until nothing changes
+static void reference_reach(game_state_t* game, const falling_piece_t* start) {
+    memset(reached, 0, sizeof(reached));
+    int origin = PIECE_GRID - 1;
+    reached[start->y + origin][start->x + origin][(int)start->rotation] = true;
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int y = 0; y < REACH_ROWS; y++) {
+            for (int x = 0; x < REACH_COLS; x++) {
+                for (int r = 0; r < 4; r++) {
+                    if (!reached[y][x][r]) continue;
+                    for (int move = 0; move < 4; move++) {
+                        falling_piece_t probe = *start;
+                        probe.x = x - origin; probe.y = y - origin; probe.rotation = r;
+                        bool moved = (move == 0) ? game_engine_move(game, &probe, -1, 0)
+                                   : (move == 1) ? game_engine_move(game, &probe, 1, 0)
+                                   : (move == 2) ? game_engine_move(game, &probe, 0, 1)
+                                   : game_engine_rotate(game, &probe);
+                        bool* next = &reached[probe.y + origin][probe.x + origin][(int)probe.rotation];
+                        if (moved && !*next) *next = changed = true;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// differential test: placement_enumerate vs. a brute force sweep of every state, on random mid-game boards,
+// plus a board where some placements can only be reached by sliding under an overhang (tuck)
+void test_placements(void) {
+    timer_init();
+    uart_init();
+    int nrows = 20; int ncols = 10;
+    placement_search_t search;
+    placement_init(&search, nrows, ncols);
+    static placement_t found[PLACEMENT_STATES(20, 10)];
+    int checks = 0; int mismatches = 0;
+
+    for (int board = 0; board < 8; board++) {
+        game_state_t game;
+        game_engine_init(&game, nrows, ncols, board);
+        fill_midgame_board(&game);
+        for (int p = 0; p < 7; p++) {
+            falling_piece_t piece = {.pieceT = pieces[p], .rotation = 0, .x = ncols / 2 - 2, .y = 0, .fallen = false};
+            int count = placement_enumerate(&search, &game, &piece, found, PLACEMENT_STATES(20, 10));
+            reference_reach(&game, &piece);
+
+            // every placement found is a reachable resting state, and no two cover the same squares
+            for (int n = 0; n < count; n++) {
+                falling_piece_t probe = piece;
+                probe.x = found[n].x; probe.y = found[n].y; probe.rotation = found[n].rotation;
+                if (!reached[probe.y + PIECE_GRID - 1][probe.x + PIECE_GRID - 1][(int)probe.rotation]) mismatches++;
+                if (!game_engine_has_fallen(&game, &probe)) mismatches++;
+                for (int other = 0; other < n; other++) {
+                    if (same_squares(&piece.pieceT, found[n].rotation, found[n].x, found[n].y,
+                                     found[other].rotation, found[other].x, found[other].y)) mismatches++;
+                }
+                checks++;
+            }
+            // every reachable resting state is one of the placements found
+            for (int y = 0; y < REACH_ROWS; y++) {
+                for (int x = 0; x < REACH_COLS; x++) {
+                    for (int r = 0; r < 4; r++) {
+                        if (!reached[y][x][r]) continue;
+                        falling_piece_t probe = piece;
+                        probe.x = x - (PIECE_GRID - 1); probe.y = y - (PIECE_GRID - 1); probe.rotation = r;
+                        if (!game_engine_has_fallen(&game, &probe)) continue;
+                        bool listed = false;
+                        for (int n = 0; n < count && !listed; n++) {
+                            listed = same_squares(&piece.pieceT, r, probe.x, probe.y, found[n].rotation, found[n].x, found[n].y);
+                        }
+                        if (!listed) mismatches++;
+                        checks++;
+                    }
+                }
+            }
+        }
+        game_engine_free(&game);
+    }
+
+    // roof over columns 2-9 in row 17: an 'o' dropped into columns 0-1 can slide all the way under it
+    game_state_t game;
+    game_engine_init(&game, nrows, ncols, 0);
+    for (int x = 2; x < ncols; x++) game_engine_set_square(&game, x, 17, 1);
+    falling_piece_t piece = {.pieceT = o, .rotation = 0, .x = ncols / 2 - 2, .y = 0, .fallen = false};
+    int count = placement_enumerate(&search, &game, &piece, found, PLACEMENT_STATES(20, 10));
+    int tucked = 0;
+    for (int n = 0; n < count; n++) {
+        const piece_geometry_t* geom = &o.geometry[(int)found[n].rotation];
+        if (found[n].y + geom->minRow == 18) tucked++;
+    }
+    game_engine_free(&game);
+    placement_free(&search);
+
+    printf("\nplacement test: %d checks, %d mismatches, %d 'o' placements (%d under the overhang)\n",
+           checks, mismatches, count, tucked);
+    assert(mismatches == 0);
+    // on the roof (left column 1 to 8), and under it (left column 0 to 8, all but the first only by sliding)
+    assert(count == (ncols - 2) + (ncols - 1) && tucked == ncols - 1);
+}
+
+// enumerations per second on mid-game boards, in both collision modes
+void test_placement_benchmark(void) {
+    timer_init();
+    uart_init();
+    int nrows = 20; int ncols = 10;
+    const int nboards = 16;
+    const int rounds = 20;
+    placement_search_t search;
+    placement_init(&search, nrows, ncols);
+    static placement_t found[PLACEMENT_STATES(20, 10)];
+    static game_state_t games[16];
+    for (int board = 0; board < nboards; board++) {
+        game_engine_init(&games[board], nrows, ncols, board);
+        fill_midgame_board(&games[board]);
+    }
+
+    for (int mode = 1; mode >= 0; mode--) {
+        long enumerations = 0; long placements = 0;
+        unsigned long start = timer_get_ticks();
+        for (int round = 0; round < rounds; round++) {
+            for (int board = 0; board < nboards; board++) {
+                game_engine_set_bitboard_mode(&games[board], mode == 1);
+                for (int p = 0; p < 7; p++) {
+                    falling_piece_t piece = {.pieceT = pieces[p], .rotation = 0, .x = ncols / 2 - 2, .y = 0, .fallen = false};
+                    placements += placement_enumerate(&search, &games[board], &piece, found, PLACEMENT_STATES(20, 10));
+                    enumerations++;
+                }
+            }
+        }
+        unsigned long ticks = timer_get_ticks() - start;
+        printf("%s: %ld enumerations (%ld placements each on average) in %ld usec -> %ld enumerations/sec\n",
+               (mode == 1) ? "bitboard" : "grid", enumerations, placements / enumerations, ticks / TICKS_PER_USEC,
+               (long)(enumerations * TICKS_PER_USEC * 1000000 / ticks));
+    }
+    for (int board = 0; board < nboards; board++) game_engine_free(&games[board]);
+    placement_free(&search);
+}
+
+// the autoplayer on the device: greedy (one piece ahead) and a small beam, each for a seeded game of up to 100 pieces
+void test_autoplayer(void) {
+    timer_init();
+    uart_init();
+    static autoplayer_t player;
+    for (int beam = 1; beam <= 4; beam += 3) {
+        autoplayer_init(&player, 20, 10, &autoplay_default_weights, beam, beam == 1 ? 1 : 2);
+        game_state_t game;
+        game_engine_init(&game, 20, 10, 107);
+        game_engine_spawn(&game);
+        int placed = 0;
+        unsigned long start = timer_get_ticks();
+        while (!game.gameOver && placed < 100) {
+            assert(autoplayer_play(&player, &game) & EVENT_LOCKED);
+            placed++;
+        }
+        unsigned long usec = (timer_get_ticks() - start) / TICKS_PER_USEC;
+        printf("autoplayer beam %d depth %d: %d pieces, %d lines, score %d, %ld nodes in %ld usec (%ld usec/piece)\n",
+               player.beamWidth, player.depth, placed, game.linesCleared, game.score, player.nodes, usec, usec / placed);
+        assert(placed == 100 && game.linesCleared >= 30);
+        game_engine_free(&game);
+        autoplayer_free(&player);
+    }
+}
+
+// anytime search: sliced as finely as it goes (one unit of work per slice), the search has to end on the same move
+// as the greedy autoplayer_choose, on every piece of a game; reports slices, slice cycles and nodes per piece
+void test_anytime_search(void) {
+    timer_init();
+    uart_init();
+    static autoplayer_t player;
+    static autoplay_task_t task;
+    autoplayer_init(&player, 20, 10, &autoplay_default_weights, 1, 1);
+    game_state_t game;
+    game_engine_init(&game, 20, 10, 107);
+    game_engine_spawn(&game);
+    int placed = 0;
+    unsigned long nodes = 0, slices = 0, cycles = 0, maxSliceCycles = 0;
+    while (!game.gameOver && placed < 100) {
+        autoplay_move_t expected, move;
+        assert(autoplayer_choose(&player, &game, &expected));
+
+        autoplayer_task_start(&player, &task, &game);
+        assert(!autoplayer_task_best(&task, &move));       // nothing found before the first slice
+        bool seen = false; int best = 0;
+        while (!autoplayer_task_run(&player, &task, 0)) {
+            // the best move so far only ever gets better
+            if (seen) assert(task.bestValue >= best);
+            seen = task.found;
+            best = task.bestValue;
+        }
+        assert(autoplayer_task_best(&task, &move));
+        assert(move.swap == expected.swap && move.placement.x == expected.placement.x
+               && move.placement.y == expected.placement.y && move.placement.rotation == expected.placement.rotation);
+        nodes += task.nodes;
+        slices += task.slices;
+        cycles += task.cycles;
+        if (task.maxSliceCycles > maxSliceCycles) maxSliceCycles = task.maxSliceCycles;
+
+        assert(autoplayer_apply(&game, &move) & EVENT_LOCKED);
+        placed++;
+    }
+    printf("anytime search: %d pieces, %ld nodes/piece, %ld slices/piece, %ld cycles/slice (most %ld)\n", placed,
+           nodes / placed, slices / placed, cycles / slices, maxSliceCycles);
+    assert(placed == 100);
+
+    // a search stopped early still has its best move so far
+    autoplay_move_t move;
+    autoplayer_task_start(&player, &task, &game);
+    for (int n = 0; n < 5; n++) autoplayer_task_run(&player, &task, 0);
+    autoplayer_task_stop(&task);
+    assert(autoplayer_task_best(&task, &move) && !task.active);
+    assert(autoplayer_task_run(&player, &task, 0));
+    game_engine_free(&game);
+    autoplayer_free(&player);
+
+    // the game on screen on autopilot: search in 100 usec slices, then play the move and lock it (as v11 does)
+    game_update_set_search(true);
+    game_update_set_seed(107);
+    game_update_init(20, 10);
+    falling_piece_t piece = init_falling_piece();
+    for (placed = 0; placed < 50 && !game_update_is_game_over(); placed++) {
+        game_update_search_start(&piece);
+        while (!game_update_search_run(100)) { }
+        assert(game_update_autoplay(&piece) && game_update_has_fallen(&piece));
+        iterateThroughPieceSquares(&piece, update_background);
+        clearRows();
+        piece = init_falling_piece();       // finishes the clear animation right away
+    }
+    unsigned long searched = game_update_get_search_pieces();
+    printf("autopilot: %d pieces, %d lines, %ld slices/piece, %ld cycles/slice (most %ld)\n", placed,
+           game_update_get_rows_cleared(), game_update_get_search_slices() / searched,
+           game_update_get_search_cycles() / game_update_get_search_slices(), game_update_get_search_max_slice_cycles());
+    assert(placed == 50 && game_update_get_rows_cleared() >= 10);
+    game_update_set_search(false);
+}
+
+// Helper to re-simulate the game's replay (as recorded and after a round trip through its serialized form) and
+// check that it reaches the game's final state; returns the replay
+static const replay_t* check_replay(void) {
+    static unsigned char bytes[REPLAY_HEADER_BYTES + REPLAY_MAX_BYTES];
+    static replay_t copy;
+    const replay_t* replay = game_update_get_replay();
+    assert(replay->finished && replay->complete);
+    int length = replay_serialize(replay, bytes, sizeof(bytes));
+    assert(length == REPLAY_HEADER_BYTES + replay->length && replay_deserialize(&copy, bytes, length));
+    for (int pass = 0; pass < 2; pass++) {
+        game_state_t sim;
+        int pieces = replay_play(pass ? &copy : replay, &sim);
+        assert(pieces == replay->pieces && sim.score == game_update_get_score());
+        assert(sim.linesCleared == game_update_get_rows_cleared() && replay_hash(&sim) == replay->hash);
+        game_engine_free(&sim);
+    }
+    // a garbled header (input length 0x80000000 or more, an empty board, a board too wide to play) is rejected
+    const int field[4] = {27, 4, 5, 5};
+    const unsigned char garbled[4] = {0x80, 0, 0, PACKED_PIECE_MAX_COLS + 1};
+    for (int n = 0; n < 4; n++) {
+        unsigned char saved = bytes[field[n]];
+        bytes[field[n]] = garbled[n];
+        assert(!replay_deserialize(&copy, bytes, length));
+        bytes[field[n]] = saved;
+    }
+    return replay;
+}
+
+// replays: a game played through game_update with pseudo-random inputs, then one on autopilot, each re-simulated
+// from its replay to the same final state; reports bytes per piece and replays (and pieces) re-simulated per second
+void test_replay(void) {
+    timer_init();
+    uart_init();
+    game_update_set_seed(107);
+    game_update_init(20, 10);
+    falling_piece_t piece = init_falling_piece();
+    int resting = 0;
+    while (!game_update_is_game_over()) {
+        switch (test_rand() % 8) {
+            case 0: move_left(&piece); break;
+            case 1: move_right(&piece); break;
+            case 2: rotate(&piece); break;
+            case 3: if (test_rand() % 8 == 0) swap(&piece); break;
+            case 4: move_down_by(&piece, 2); break;
+            default: move_down(&piece); break;
+        }
+        // lock after a few inputs on the stack (tucks still possible meanwhile)
+        resting = game_update_has_fallen(&piece) ? resting + 1 : 0;
+        if (resting > 3) {
+            iterateThroughPieceSquares(&piece, update_background);
+            clearRows();
+            piece = init_falling_piece();       // finishes the clear animation right away
+            resting = 0;
+        }
+    }
+    const replay_t* replay = check_replay();
+    printf("replay: %d pieces, %d lines, %d bytes of inputs (%d.%d bytes/piece)\n", replay->pieces, replay->lines,
+           replay->length, replay->length / replay->pieces, 10 * replay->length / replay->pieces % 10);
+
+    // re-simulation as a workload: the same replay over and over, as fast as it goes
+    int runs = 200;
+    unsigned long start = timer_get_ticks();
+    for (int run = 0; run < runs; run++) {
+        game_state_t sim;
+        replay_play(replay, &sim);
+        game_engine_free(&sim);
+    }
+    unsigned long usec = (timer_get_ticks() - start) / TICKS_PER_USEC;
+    if (usec == 0) usec = 1;
+    printf("replay: %d re-simulations in %ld usec (%ld replays/sec, %ld pieces/sec)\n", runs, usec,
+           runs * 1000000L / usec, (long)runs * replay->pieces * 1000000L / usec);
+
+    // autopilot moves are recorded as placements
+    game_update_set_search(true);
+    game_update_set_seed(108);
+    game_update_init(20, 10);
+    piece = init_falling_piece();
+    for (int placed = 0; placed < 40 && !game_update_is_game_over(); placed++) {
+        game_update_search_start(&piece);
+        while (!game_update_search_run(100)) { }
+        assert(game_update_autoplay(&piece));
+        iterateThroughPieceSquares(&piece, update_background);
+        clearRows();
+        piece = init_falling_piece();
+    }
+    replay = check_replay();
+    printf("autopilot replay: %d pieces, %d lines, %d bytes (%d bytes/piece)\n", replay->pieces, replay->lines,
+           replay->length, replay->length / replay->pieces);
+    game_update_set_search(false);
+}
+
+// scripted remote input: every poll gets its step's tilt, presses come at a step's first poll, the script repeats,
+// and the remote stays level once it's done; then the same steps over and over as fast as they parse
+void test_remote_script(void) {
+    timer_init();
+    uart_init();
+    // expected pitch, roll and presses for each poll of one pass of the script
+    static const int expected[][3] = {
+        {X_HOME, LEFT, 0}, {X_HOME, LEFT, 0}, {X_HOME, HOME, 1}, {X_FAST, HOME, 0}, {X_FAST, HOME, 0},
+        {X_FAST, HOME, 0}, {X_SWAP, HOME, 2}, {X_HOME, RIGHT, 0},
+    };
+    const int steps = sizeof(expected) / sizeof(expected[0]);
+    remote_script_start("2L P 3.F # fast drop\n SPP,R", 2);
+    for (int poll = 0; poll < 2 * steps; poll++) {
+        int pitch = -1; int roll = -1;
+        assert(!remote_script_done());
+        remote_get_x_y_status(&pitch, &roll);
+        int presses = 0;
+        while (remote_is_button_press()) presses++;
+        const int* step = expected[poll % steps];
+        assert(pitch == step[0] && roll == step[1] && presses == step[2]);
+    }
+    int pitch, roll;
+    remote_get_x_y_status(&pitch, &roll);
+    assert(pitch == X_HOME && roll == HOME && !remote_is_button_press() && remote_script_done());
+
+    // a press nobody reads during its step is gone by the next step
+    remote_script_start("PP L", 1);
+    remote_get_x_y_status(&pitch, &roll);
+    assert(remote_is_button_press());
+    remote_get_x_y_status(&pitch, &roll);
+    assert(roll == LEFT && !remote_is_button_press());
+
+    int polls = 100000;
+    remote_script_start("20. 6L 40F 10R 3S", polls);
+    unsigned long start = timer_get_ticks();
+    for (int poll = 0; poll < polls; poll++) remote_get_x_y_status(&pitch, &roll);
+    unsigned long usec = (timer_get_ticks() - start) / TICKS_PER_USEC;
+    remote_script_start(NULL, 0);
+    printf("remote script test passed: %d scripted polls in %ld usec\n", polls, usec);
+}
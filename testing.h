@@ -1,6 +1,8 @@
 #ifndef _TESTING_H
 #define _TESTING_H
 
+#include <stdbool.h>
+
 // void pause(const char *message);
 void test_random_init(void);
 void test_basic_block_motion(void);
@@ -19,4 +21,31 @@ void integration_test_v6(void) ; // testing with tuck, polishing game loop
 void integration_test_v8(void) ; // tetris theme intrp with blinking screen
 void integration_test_v9(void) ; // tetris theme intrp with game
 void integration_test_v10(void) ; // with speedup dropping blocks
+void integration_test_v11(bool autopilot) ; // v10 with idle-time search: hint outline, or the computer plays
+void integration_test_v12(const char *script, int repeats) ; // v10 on scripted input (NULL -> over UART), with a timing report
+extern const char benchmark_script[] ; // built-in input script for integration_test_v12
+void test_bitboard_collision(void) ; // bitboard vs. callback collision checks
+void test_bitboard_benchmark(void) ; // collision tests per second
+void test_clear_rows(void) ; // single-pass line clear + non-blocking animation
+void test_board_ring(void) ; // ring board storage vs. plain grid
+void test_board_clear_benchmark(void) ; // line clear cost on 20/200/2000-row boards
+void test_landing_row(void) ; // column-height landing row vs. stepping down
+void test_game_engine(void) ; // headless engine: reentrant, deterministic for a seed
+void test_snapshots(void) ; // snapshot save/restore and copy-on-write boards
+void test_board_cells_benchmark(void) ; // 4-bit palette squares vs. color_t squares (memory and speed)
+void test_move_cost(void) ; // engine cost per move (compare STATIC_BOARD and dynamic builds)
+void test_piece_sets(void) ; // tetromino and pentomino sets: collision, headless games, bag fairness
+void test_piece_queue(void) ; // lookahead queue: spawn order, swap, snapshots
+void test_game_input(void) ; // time-based auto-repeat and lock delay vs. loop speed
+void test_game_scheduler(void) ; // fixed-timestep tasks: catch-up, dropped ticks, gravity curve
+void test_fixed_point(void) ; // Q16.16 math and tick conversions (no soft-float)
+void test_timer_wheel(void) ; // software timers on one hardware timer: one-shot, periodic, cancel
+void test_game_events(void) ; // deferred game events: subscriber masks, order, full queue
+void test_frame_coalescing(void) ; // deferred rendering: several moves in a frame, one redraw
+void test_placements(void) ; // reachable placements (with tucks) vs. a brute force sweep of piece states
+void test_placement_benchmark(void) ; // placement enumerations per second on mid-game boards
+void test_autoplayer(void) ; // computer player: 100 pieces greedy and with a small beam search
+void test_anytime_search(void) ; // idle-time search in slices ends on the greedy player's move
+void test_replay(void) ; // replays re-simulate to the game's final state; replays per second
+void test_remote_script(void) ; // remote inputs from a script instead of the accelerometer and button
 #endif
\ No newline at end of file
@@ -0,0 +1,125 @@
+/* timer_wheel.c
+* -----------------------------------
+* Author: Anjali Sreenivas (anjalisr)
+*
+* The timer_wheel.c module runs any number of one-shot and periodic software timers off one hardware timer
+* interrupt (HSTIMER1, ticking every TIMER_WHEEL_TICK_US), so modules can schedule work (note changes, servo
+* pulses, blinking) instead of busy-waiting with timer_delay_*. HSTIMER0 stays free for the buzzer's tone.
+*/
+
+#include "timer_wheel.h"
+#include "hstimer.h"
+#include "interrupts.h"
+#include <stddef.h>
+
+#define SLOT_MASK (TIMER_WHEEL_SLOTS - 1)
+
+static struct {
+    sw_timer_t *slots[TIMER_WHEEL_SLOTS];
+    unsigned long now;          // ticks since init
+    bool inTick;                // true while timer_wheel_tick runs callbacks (interrupt context)
+    bool initialized;
+} wheel;
+
+// Helpers to keep the tick interrupt out while main code changes slot lists (callbacks already run inside it,
+// and before init there is no interrupt)
+static void lock(void) {
+    if (wheel.initialized && !wheel.inTick) interrupts_disable_source(INTERRUPT_SOURCE_HSTIMER1);
+}
+
+static void unlock(void) {
+    if (wheel.initialized && !wheel.inTick) interrupts_enable_source(INTERRUPT_SOURCE_HSTIMER1);
+}
+
+// Helper to put timer in the slot delayTicks (at least 1) from now
+static void insert(sw_timer_t *timer, unsigned long delayTicks) {
+    sw_timer_t **slot = &wheel.slots[(wheel.now + delayTicks) & SLOT_MASK];
+    timer->rounds = (delayTicks - 1) / TIMER_WHEEL_SLOTS;
+    timer->next = *slot;
+    if (*slot != NULL) (*slot)->pprev = &timer->next;
+    timer->pprev = slot;
+    *slot = timer;
+    timer->active = true;
+}
+
+static void unlink(sw_timer_t *timer) {
+    *timer->pprev = timer->next;
+    if (timer->next != NULL) timer->next->pprev = timer->pprev;
+    timer->active = false;
+}
+
+// Helper to convert microseconds to wheel ticks, rounding up (at least 1 tick)
+static unsigned long toTicks(unsigned long us) {
+    unsigned long ticks = (us + TIMER_WHEEL_TICK_US - 1) / TIMER_WHEEL_TICK_US;
+    return ticks ? ticks : 1;
+}
+
+// Advances the wheel one tick and runs the timers that expire on it; periodic timers go back in for their next
+// period before their callback runs (so a callback may cancel its own timer). The slot's list is detached first
+// and walked from its head, so callbacks may also cancel or restart any other timer, including ones later in it.
+// Called by the tick interrupt.
+void timer_wheel_tick(void) {
+    wheel.inTick = true;
+    wheel.now++;
+    sw_timer_t **slot = &wheel.slots[wheel.now & SLOT_MASK];
+    sw_timer_t *list = *slot;
+    *slot = NULL;
+    if (list != NULL) list->pprev = &list;
+    while (list != NULL) {
+        sw_timer_t *timer = list;
+        unlink(timer);
+        if (timer->rounds > 0) {
+            insert(timer, timer->rounds * TIMER_WHEEL_SLOTS);     // same slot, one turn fewer to wait
+        } else {
+            if (timer->periodTicks) insert(timer, timer->periodTicks);
+            timer->fn(timer->aux);
+        }
+    }
+    wheel.inTick = false;
+}
+
+// handler for INTERRUPT_SOURCE_HSTIMER1
+static void handle_tick(uintptr_t pc, void *aux_data) {
+    hstimer_interrupt_clear(HSTIMER1);
+    timer_wheel_tick();
+    hstimer_enable(HSTIMER1);
+}
+
+// Required init: starts the tick interrupt on HSTIMER1 (safe to call more than once)
+void timer_wheel_init(void) {
+    if (wheel.initialized) return;
+    wheel.initialized = true;
+    interrupts_register_handler(INTERRUPT_SOURCE_HSTIMER1, handle_tick, NULL);
+    interrupts_enable_source(INTERRUPT_SOURCE_HSTIMER1);
+    hstimer_init(HSTIMER1, TIMER_WHEEL_TICK_US);
+    hstimer_enable(HSTIMER1);
+}
+
+// Starts (or restarts) timer: fn(aux) runs delayUs from now, then every periodUs after that (0 -> just once).
+// Times are rounded up to whole ticks. A start from main code happens somewhere between two ticks, so it waits one
+// more tick: the timer may fire up to a tick late, but never early. Callbacks run on a tick, so theirs don't.
+void timer_wheel_start(sw_timer_t *timer, unsigned long delayUs, unsigned long periodUs, timer_fn_t fn, void *aux) {
+    lock();
+    if (timer->active) unlink(timer);
+    timer->fn = fn;
+    timer->aux = aux;
+    timer->periodTicks = periodUs ? toTicks(periodUs) : 0;
+    insert(timer, toTicks(delayUs) + (wheel.inTick ? 0 : 1));
+    unlock();
+}
+
+// Stops timer if it's running (O(1)); a stopped timer can be started again
+void timer_wheel_cancel(sw_timer_t *timer) {
+    lock();
+    if (timer->active) unlink(timer);
+    unlock();
+}
+
+bool timer_wheel_is_active(const sw_timer_t *timer) {
+    return timer->active;
+}
+
+// Returns ticks since init (TIMER_WHEEL_TICK_US each)
+unsigned long timer_wheel_ticks(void) {
+    return wheel.now;
+}
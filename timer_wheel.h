@@ -0,0 +1,39 @@
+#ifndef _TIMER_WHEEL_H
+#define _TIMER_WHEEL_H
+
+#include <stdbool.h>
+
+/* Software timers multiplexed on one hardware timer (HSTIMER1): a hashed timing wheel of TIMER_WHEEL_SLOTS slots
+advanced by a TIMER_WHEEL_TICK_US interrupt. A timer goes into the slot it expires in (with the number of full
+turns of the wheel still to wait), so starting and cancelling a timer are O(1) list operations and each tick only
+visits the timers in one slot. Timers are caller-owned structs that start out zeroed (e.g. static), so the wheel never allocates.
+Callbacks run in interrupt context: keep them short (set a flag, toggle a pin, start another timer).
+*/
+#define TIMER_WHEEL_TICK_US 1000
+#define TIMER_WHEEL_SLOTS 256       // power of two; timers up to SLOTS ticks away never wait out a turn of the wheel
+
+typedef void (*timer_fn_t)(void *aux);
+
+typedef struct sw_timer {
+    struct sw_timer *next;          // slot list links (pprev points at whatever points to this timer)
+    struct sw_timer **pprev;
+    unsigned long rounds;           // full turns of the wheel left before the timer expires
+    unsigned long periodTicks;      // 0 -> one-shot
+    timer_fn_t fn;
+    void *aux;
+    bool active;
+} sw_timer_t;
+
+void timer_wheel_init(void);
+
+void timer_wheel_start(sw_timer_t *timer, unsigned long delayUs, unsigned long periodUs, timer_fn_t fn, void *aux);
+
+void timer_wheel_cancel(sw_timer_t *timer);
+
+bool timer_wheel_is_active(const sw_timer_t *timer);
+
+unsigned long timer_wheel_ticks(void);
+
+void timer_wheel_tick(void);
+
+#endif